@@ -33,7 +33,7 @@
             <xsl:value-of select="level/background/@src"/>
           </code>
         </p>
-        <xsl:for-each select="level/point">
+        <xsl:for-each select="level/point | level/track/point">
           <p class="point">
             X: <xsl:value-of select="@x"/> Y: <xsl:value-of select="@y"/>
           </p>
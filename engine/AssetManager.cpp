@@ -1,11 +1,39 @@
 #include "../engine/AssetManager.h"
+#include "../game/LevelFile.h"
 
 AMAssetLoadException::AMAssetLoadException(const char* msg) : msg(msg) {}
-const char* AMAssetLoadException::what() { return msg; }
+const char* AMAssetLoadException::what() { return msg.c_str(); }
 
 AssetManager::AssetManager() {}
 
+bool AssetManager::open_pack(const string& pack_path) {
+	try {
+		pack = make_unique<AssetPack>(pack_path);
+	}
+	catch (AssetPackException& e) {
+		log_warn("AssetManager: Couldn't open the asset pack '%s', loading assets from files. Error: %s\n", pack_path.c_str(), e.what());
+		return false;
+	}
+
+	log_info("AssetManager: Asset pack '%s' opened with %u assets.\n", pack_path.c_str(), static_cast<uint>(pack->get_entries().size()));
+	return true;
+}
+
+SDL_RWops* AssetManager::open_asset(const string& asset_path) const {
+	if (pack) {
+		// pack entries are named by normalized relative paths, like "assets/levels/level1.xml"
+		string name = path(asset_path).lexically_normal().generic_string();
+		if (SDL_RWops* io = pack->open(name))
+			return io;
+	}
+
+	return SDL_RWFromFile(asset_path.c_str(), "rb");
+}
+
 AssetManager::~AssetManager() {
+	// the prefetches are waited for before the rest is destroyed
+	background_prefetches.clear();
+
 	for (auto& pair : textures)
 		pair.second.destroy();
 
@@ -59,50 +87,62 @@ bool AssetManager::is_signature_valid(const unsigned char* signature_data) {
 	return signature_data[0] == 'C' && signature_data[1] == 'A' && signature_data[2] == 'A' && signature_data[3] == 'S' && signature_data[4] == 'S';
 }
 
-void AssetManager::load_texture(const string& id, const string& path, SDL_Renderer* renderer) {
-	// the asset is already loaded, there's no need to load it again
-	if (textures.find(id) != textures.end()) return;
+void AssetManager::decode_asset_image(const string& file_path, const AssetType& expected_type, unsigned char* header, const size_t& header_size, DecodedImage& decoded) {
+	auto c_path_str = file_path.c_str();
 
-	// construct the path string
-	auto constructed_path = string(prefix) + path;
-	auto c_path_str = constructed_path.c_str();
-	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Loading a texture with id '%s' on path '%s'...\n", id.c_str(), c_path_str);
-
-	// open file for reading in binary form
-	SDL_RWops* io = SDL_RWFromFile(c_path_str, "rb");
-	// allocate a C string for signature data
-	unsigned char* signature_data = (unsigned char*)malloc(6 * sizeof(unsigned char));
+	// open the asset for reading
+	SDL_RWops* io = open_asset(file_path);
+	if (io == nullptr) {
+		auto sdl_error = SDL_GetError();
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open %s! Error: %s\n", c_path_str, sdl_error);
+		throw AMAssetLoadException(sdl_error);
+	}
 
-	// if couldn't allocate, throw an error
-	if (!signature_data) throw runtime_error("couldn't create allocate signature_data!");
+	decoded.bytes_read = static_cast<Uint64>(SDL_RWsize(io));
 
-	// if couldn't read first 6 bytes, log and throw an error
-	if (SDL_RWread(io, signature_data, 6 * sizeof(unsigned char), 1) <= 0) {
+	// if couldn't read the header, log and throw an error
+	if (SDL_RWread(io, header, header_size * sizeof(unsigned char), 1) <= 0) {
 		auto sdl_error = SDL_GetError();
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load texture %s! Error: %s\n", c_path_str, sdl_error);
+		SDL_RWclose(io);
 		throw AMAssetLoadException(sdl_error);
 	}
 
 	// if the signature read isn't valid (first 5 bytes don't match the asset signature),
 	// log and throw an error
-	if (!is_signature_valid(signature_data)) {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Signature of loaded file is invalid!\n");
+	if (!is_signature_valid(header)) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Signature of loaded file %s is invalid!\n", c_path_str);
+		SDL_RWclose(io);
 		throw AMAssetLoadException("invalid signature");
 	}
 
-	// get the asset type from the 6th byte (after the asset signature)
-	auto asset_type = (AssetType)signature_data[5];
-
-	// we don't need signature_data, free it
-	free(signature_data);
-
-	// if the asset type isn't a Texture, log and throw an error
-	if (asset_type != AssetType::ATTexture) {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Loading non-texture as texture!");
+	// get the asset type from the 6th byte (after the asset signature),
+	// if it isn't the expected one, log and throw an error
+	auto asset_type = (AssetType)header[5];
+	bool is_raw = expected_type == ATTexture && asset_type == ATRawTexture;
+	if (asset_type != expected_type && !is_raw) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Loading %s as a wrong asset type!\n", c_path_str);
+		SDL_RWclose(io);
 		throw AMAssetLoadException("invalid asset type");
 	}
 
-	// load the PNG data from the file's RWops
+	// raw pixels only have to be read (and decompressed), there's no PNG to decode
+	if (is_raw) {
+		RawTextureHeader raw_header;
+		decoded.surface = RawTexture::decode(io, raw_header);
+		decoded.is_raw = true;
+		decoded.is_premultiplied = raw_header.is_premultiplied();
+		SDL_RWclose(io);
+
+		if (decoded.surface == nullptr) {
+			auto sdl_error = SDL_GetError();
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load raw texture %s! Error: %s\n", c_path_str, sdl_error);
+			throw AMAssetLoadException(sdl_error);
+		}
+		return;
+	}
+
+	// load the PNG data from the file's RWops, which is closed afterwards
 	SDL_Surface* surface = IMG_LoadTyped_RW(io, 1, "PNG");
 	// in case of an error (surface = nullptr) throw the error as an exception
 	if (surface == nullptr) {
@@ -111,23 +151,117 @@ void AssetManager::load_texture(const string& id, const string& path, SDL_Render
 		throw AMAssetLoadException(sdl_error);
 	}
 
+	decoded.surface = surface;
+}
+
+SDL_Texture* AssetManager::upload_surface(SDL_Renderer* renderer, SDL_Surface* surface, const string& file_path) {
 	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-	// same as above error handling
 	if (texture == nullptr) {
 		auto sdl_error = SDL_GetError();
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load image %s! Error: %s\n", c_path_str, sdl_error);
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load image %s! Error: %s\n", file_path.c_str(), sdl_error);
+		throw AMAssetLoadException(sdl_error);
+	}
+
+	return texture;
+}
+
+SDL_Texture* AssetManager::upload_raw_image(SDL_Renderer* renderer, DecodedImage& decoded, const string& file_path) {
+	SDL_Surface* surface = decoded.surface;
+	SDL_Texture* texture = SDL_CreateTexture(renderer, surface->format->format, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+	if (texture == nullptr) {
+		auto sdl_error = SDL_GetError();
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create texture for %s! Error: %s\n", file_path.c_str(), sdl_error);
+		throw AMAssetLoadException(sdl_error);
+	}
+
+	// premultiplied colors are added to the destination as they are, instead of being multiplied by the alpha
+	static const SDL_BlendMode PREMULTIPLIED_BLEND_MODE = SDL_ComposeCustomBlendMode(
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD
+	);
+
+	// not every renderer supports custom blend modes (the software one doesn't),
+	// the pixels are converted back to straight alpha for those
+	if (decoded.is_premultiplied && SDL_SetTextureBlendMode(texture, PREMULTIPLIED_BLEND_MODE) != 0) {
+		log_verbose("AssetManager: Premultiplied alpha isn't supported by the renderer, converting %s to straight alpha.\n", file_path.c_str());
+		RawTexture::unpremultiply(surface);
+		decoded.is_premultiplied = false;
+	}
+
+	if (!decoded.is_premultiplied)
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+	if (SDL_UpdateTexture(texture, nullptr, surface->pixels, surface->pitch) != 0) {
+		auto sdl_error = SDL_GetError();
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't upload texture %s! Error: %s\n", file_path.c_str(), sdl_error);
+		SDL_DestroyTexture(texture);
 		throw AMAssetLoadException(sdl_error);
 	}
 
-	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	return texture;
+}
 
-	// encapsulate raw texture pointer, it's width and height in a Texture object
-	Texture t_data(surface->w, surface->h, texture);
+AssetManager::QueuedLoad AssetManager::make_texture_load(const string& id, const string& path, const bool& reload) {
+	// construct the path string
+	auto constructed_path = string(prefix) + path;
+	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Loading a texture with id '%s' on path '%s'...\n", id.c_str(), constructed_path.c_str());
+
+	auto decoded = make_shared<DecodedImage>();
+
+	auto record = make_shared<AssetLoadRecord>();
+	record->id = id;
+	record->kind = "texture";
+
+	return {
+		record,
+		[=, this]() {
+			unsigned char header[6];
+			decode_asset_image(constructed_path, ATTexture, header, sizeof(header), *decoded);
+		},
+		[=, this](SDL_Renderer* renderer) {
+			// the same texture could be queued twice, a reload replaces the loaded one
+			auto existing = textures.find(id);
+			if (existing != textures.end() && !reload) return false;
+
+			SDL_Texture* texture = nullptr;
+			if (decoded->is_raw) {
+				texture = upload_raw_image(renderer, *decoded, constructed_path);
+			}
+			else {
+				texture = upload_surface(renderer, decoded->surface, constructed_path);
+				SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+			}
+
+			// encapsulate raw texture pointer, it's width and height in a Texture object
+			Texture t_data(decoded->surface->w, decoded->surface->h, texture);
+			t_data.set_premultiplied_alpha(decoded->is_premultiplied);
+			if (existing != textures.end()) {
+				existing->second.replace(t_data);
+			}
+			else {
+				textures.insert({ id, t_data });
+				asset_sources.insert({ get_source_key(constructed_path), { ATTexture, id, path } });
+			}
+
+			record->bytes_read = decoded->bytes_read;
+			record->gpu_bytes = static_cast<Uint64>(t_data.get_width()) * t_data.get_height() * 4;
+			return true;
+		}
+	};
+}
+
+void AssetManager::load_texture(const string& id, const string& path, SDL_Renderer* renderer) {
+	// the asset is already loaded, there's no need to load it again
+	if (textures.find(id) != textures.end()) return;
 
-	// after the texture is loaded, the surface is no longer needed, so it is freed
-	SDL_FreeSurface(surface);
+	QueuedLoad load = make_texture_load(id, path);
+	decode_load(load);
+	finish_load(load, renderer);
+}
 
-	textures.insert({ id, t_data });
+void AssetManager::queue_texture(const string& id, const string& path) {
+	if (textures.find(id) != textures.end()) return;
+	queued_loads.push_back(make_texture_load(id, path));
 }
 
 void AssetManager::unload_texture(const string& id) {
@@ -146,100 +280,88 @@ float AssetManager::convert_float_type(unsigned char* data) {
 	return static_cast<float>(static_cast<uint>(data[0]) * 0x100 + static_cast<uint>(data[1]));
 }
 
-void AssetManager::load_ui_texture(const string& id, const string& path, SDL_Renderer* renderer) {
-	// the asset is already loaded, there's no need to load it again
-	if (ui_textures.find(id) != ui_textures.end()) return;
-
+AssetManager::QueuedLoad AssetManager::make_ui_texture_load(const string& id, const string& path, const bool& reload) {
 	// construct the path string
 	auto constructed_path = string(prefix) + path;
-	auto c_path_str = constructed_path.c_str();
-	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Loading a UI texture with id '%s' on path '%s'...\n", id.c_str(), c_path_str);
-
-	// open file for reading in binary form
-	SDL_RWops* io = SDL_RWFromFile(c_path_str, "rb");
-	// allocate a C string for signature data
-	unsigned char* signature_data = (unsigned char*)malloc(17 * sizeof(unsigned char));
-
-	// if couldn't allocate, throw an error
-	if (!signature_data) throw runtime_error("couldn't create allocate signature_data!");
-
-	// if couldn't read first 17 bytes, log and throw an error
-	if (SDL_RWread(io, signature_data, 17 * sizeof(unsigned char), 1) <= 0) {
-		auto sdl_error = SDL_GetError();
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load texture %s! Error: %s\n", c_path_str, sdl_error);
-		throw AMAssetLoadException(sdl_error);
-	}
-
-	// if the signature read isn't valid (first 5 bytes don't match the asset signature),
-	// log and throw an error
-	if (!is_signature_valid(signature_data)) {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Signature of loaded file is invalid!");
-		throw AMAssetLoadException("invalid signature");
-	}
-
-	// get the asset type from the 6th byte (after the asset signature)
-	auto asset_type = (AssetType)signature_data[5];
-
-	// if the asset type isn't a Texture, log and throw an error
-	if (asset_type != AssetType::ATUITexture) {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Loading non-texture as texture!");
-		throw AMAssetLoadException("invalid asset type");
-	}
-
-	// load the PNG data from the file's RWops
-	SDL_Surface* surface = IMG_LoadTyped_RW(io, 1, "PNG");
-	// in case of an error (surface = nullptr) throw the error as an exception
-	if (surface == nullptr) {
-		auto sdl_error = IMG_GetError();
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load image %s! Error: %s\n", c_path_str, sdl_error);
-		throw AMAssetLoadException(sdl_error);
-	}
-
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-	// same as above error handling
-	if (texture == nullptr) {
-		auto sdl_error = SDL_GetError();
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load image %s! Error: %s\n", c_path_str, sdl_error);
-		throw AMAssetLoadException(sdl_error);
-	}
-
-	UITexture::UIProperties ui_props;
-
-	// scaling is represented by 2 bytes in a row
-	unsigned char high_scale_byte = signature_data[6];
-	unsigned char low_scale_byte = signature_data[7];
-
-	// example: 17 DE -> high_byte = 0x17; low_byte = 0xDE;
-	// high_byte * 0x100 = 0x1700
-	// scaling = (0x1700 + low_byte) / 100 = 0x17DE / 100 = 6110 / 100 = 61.10
-	ui_props.scaling = (static_cast<float>(high_scale_byte) * 0x100 + static_cast<float>(low_scale_byte)) / 100;
-
-	// stretching settings are represented by a single byte, 
-	// where the second bit (0b10) represents the X stretch
-	// and the first bit (0b01) represents the Y stretch
-	char stretch_byte = signature_data[8];
-	bitset<8> stretch_bits(stretch_byte);
-	ui_props.stretch_x = stretch_bits[1];
-	ui_props.stretch_y = stretch_bits[0];
-
-	// cutting margins are represented by 2 bytes in a row in the following order:
-	// left right top bottom
-
-	ui_props.left = static_cast<uint>(convert_float_type(signature_data + 9));
-	ui_props.right = static_cast<uint>(convert_float_type(signature_data + 11));
-	ui_props.top = static_cast<uint>(convert_float_type(signature_data + 13));
-	ui_props.bottom = static_cast<uint>(convert_float_type(signature_data + 15));
-
-	// encapsulate raw texture pointer, it's width and height in a Texture object
-	UITexture t_data(surface->w, surface->h, texture, ui_props);
+	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Loading a UI texture with id '%s' on path '%s'...\n", id.c_str(), constructed_path.c_str());
+
+	auto decoded = make_shared<DecodedImage>();
+	auto header = make_shared<array<unsigned char, 17>>();
+
+	auto record = make_shared<AssetLoadRecord>();
+	record->id = id;
+	record->kind = "ui texture";
+
+	return {
+		record,
+		[=, this]() {
+			decode_asset_image(constructed_path, ATUITexture, header->data(), header->size(), *decoded);
+		},
+		[=, this](SDL_Renderer* renderer) {
+			// the same texture could be queued twice, a reload replaces the loaded one
+			auto existing = ui_textures.find(id);
+			if (existing != ui_textures.end() && !reload) return false;
+
+			SDL_Texture* texture = upload_surface(renderer, decoded->surface, constructed_path);
+			unsigned char* signature_data = header->data();
+
+			UITexture::UIProperties ui_props;
+
+			// scaling is represented by 2 bytes in a row
+			unsigned char high_scale_byte = signature_data[6];
+			unsigned char low_scale_byte = signature_data[7];
+
+			// example: 17 DE -> high_byte = 0x17; low_byte = 0xDE;
+			// high_byte * 0x100 = 0x1700
+			// scaling = (0x1700 + low_byte) / 100 = 0x17DE / 100 = 6110 / 100 = 61.10
+			ui_props.scaling = (static_cast<float>(high_scale_byte) * 0x100 + static_cast<float>(low_scale_byte)) / 100;
+
+			// stretching settings are represented by a single byte, 
+			// where the second bit (0b10) represents the X stretch
+			// and the first bit (0b01) represents the Y stretch
+			char stretch_byte = signature_data[8];
+			bitset<8> stretch_bits(stretch_byte);
+			ui_props.stretch_x = stretch_bits[1];
+			ui_props.stretch_y = stretch_bits[0];
+
+			// cutting margins are represented by 2 bytes in a row in the following order:
+			// left right top bottom
+
+			ui_props.left = static_cast<uint>(convert_float_type(signature_data + 9));
+			ui_props.right = static_cast<uint>(convert_float_type(signature_data + 11));
+			ui_props.top = static_cast<uint>(convert_float_type(signature_data + 13));
+			ui_props.bottom = static_cast<uint>(convert_float_type(signature_data + 15));
+
+			// encapsulate raw texture pointer, it's width and height in a Texture object
+			UITexture t_data(decoded->surface->w, decoded->surface->h, texture, ui_props);
+			if (existing != ui_textures.end()) {
+				existing->second.replace(t_data);
+				existing->second.ui_properties = ui_props;
+			}
+			else {
+				ui_textures.insert({ id, t_data });
+				asset_sources.insert({ get_source_key(constructed_path), { ATUITexture, id, path } });
+			}
+
+			record->bytes_read = decoded->bytes_read;
+			record->gpu_bytes = static_cast<Uint64>(t_data.get_width()) * t_data.get_height() * 4;
+			return true;
+		}
+	};
+}
 
-	// after the texture is loaded, the surface is no longer needed, so it is freed
-	SDL_FreeSurface(surface);
+void AssetManager::load_ui_texture(const string& id, const string& path, SDL_Renderer* renderer) {
+	// the asset is already loaded, there's no need to load it again
+	if (ui_textures.find(id) != ui_textures.end()) return;
 
-	// we don't need signature_data, free it
-	free(signature_data);
+	QueuedLoad load = make_ui_texture_load(id, path);
+	decode_load(load);
+	finish_load(load, renderer);
+}
 
-	ui_textures.insert({ id, t_data });
+void AssetManager::queue_ui_texture(const string& id, const string& path) {
+	if (ui_textures.find(id) != ui_textures.end()) return;
+	queued_loads.push_back(make_ui_texture_load(id, path));
 }
 
 void AssetManager::unload_ui_texture(const string& id) {
@@ -260,94 +382,317 @@ uint AssetManager::convert_uint_type(unsigned char* data) {
 	return static_cast<uint>(first_byte) * 0x100 + static_cast<uint>(second_byte);
 }
 
+AssetManager::QueuedLoad AssetManager::make_level_data_load(const string& id, const path& asset_path, const bool& reload) {
+	// construct the path string
+	auto path_str = asset_path.string();
+
+	log_verbose("AssetManager: Loading a level data with id '%s' on path '%s'...\n", id.c_str(), path_str.c_str());
+
+	// the level data stays empty if the level is invalid
+	auto level_data = make_shared<optional<LevelData>>();
+
+	auto record = make_shared<AssetLoadRecord>();
+	record->id = id;
+	record->kind = "level";
+
+	return {
+		record,
+		[=, this]() {
+			auto c_path_str = path_str.c_str();
+
+			// open the level document for reading
+			SDL_RWops* io = open_asset(path_str);
+
+			if (!io) {
+				auto sdl_error = SDL_GetError();
+				log_error("AssetManager: Couldn't load level data on path '%s'! Error: %s.\n", c_path_str, sdl_error);
+				throw AMAssetLoadException(sdl_error);
+			}
+
+			// the whole file is read into a buffer sized to it, which is freed with the load
+			vector<Uint8> level_bytes(static_cast<size_t>(max(SDL_RWsize(io), static_cast<Sint64>(0))));
+			size_t read = level_bytes.empty() ? 0 : SDL_RWread(io, level_bytes.data(), level_bytes.size(), 1);
+			SDL_RWclose(io);
+			record->bytes_read = level_bytes.size();
+
+			if (read != 1) {
+				auto sdl_error = SDL_GetError();
+				log_error("AssetManager: Couldn't read level data on path '%s'! Error: %s.\n", c_path_str, sdl_error);
+				throw AMAssetLoadException(sdl_error);
+			}
+
+			LevelData data;
+			data.id = id;
+
+			// compiled levels store the precomputed track, level XML is parsed and it's track is computed here
+			bool is_compiled =
+				level_bytes.size() >= 6 && is_signature_valid(level_bytes.data()) && level_bytes[5] == ATLevel;
+			bool is_valid = is_compiled
+				? LevelFile::read(level_bytes.data() + 6, level_bytes.size() - 6, asset_path, data)
+				: LevelFile::parse_xml(reinterpret_cast<const char*>(level_bytes.data()), level_bytes.size(), asset_path, data);
+
+			if (is_valid)
+				*level_data = move(data);
+		},
+		[=, this](SDL_Renderer* renderer) {
+			// the same level could be queued twice, or it was invalid
+			auto existing = levels.find(id);
+			if ((existing != levels.end() && !reload) || !level_data->has_value()) return false;
+
+			if (existing == levels.end()) {
+				levels.insert({ id, move(level_data->value()) });
+				asset_sources.insert({ get_source_key(path_str), { ATLevel, id, path_str } });
+				return true;
+			}
+
+			// a reloaded level is updated in place, the revision tells the running level to rebuild it's track
+			LevelData& data = level_data->value();
+			bool is_background_changed = data.background_path != existing->second.background_path;
+			data.background = existing->second.background;
+			data.revision = existing->second.revision + 1;
+			existing->second = move(data);
+
+			// the cached background could be shown by the running level, so it's replaced in place
+			if (is_background_changed && cached_backgrounds.find(id) != cached_backgrounds.end()) {
+				QueuedLoad background_load = make_level_background_load(id, existing->second.background_path, true);
+				decode_load(background_load);
+				finish_load(background_load, renderer);
+			}
+			return true;
+		}
+	};
+}
+
 void AssetManager::load_level_data(const string& id, const path& asset_path, SDL_Renderer* renderer) {
 	// the asset is already loaded, there's no need to load it again
 	if (levels.find(id) != levels.end()) return;
 
-	// construct the path string
-	auto path_str = asset_path.string();
-	auto c_path_str = path_str.c_str();
+	QueuedLoad load = make_level_data_load(id, asset_path);
+	decode_load(load);
+	finish_load(load, renderer);
+}
 
-	log_verbose("AssetManager: Loading a level data with id '%s' on path '%s'...\n", id.c_str(), c_path_str);
+void AssetManager::queue_level_data(const string& id, const path& asset_path) {
+	if (levels.find(id) != levels.end()) return;
+	queued_loads.push_back(make_level_data_load(id, asset_path));
+}
 
-	// open file for reading in binary form
-	SDL_RWops* io = SDL_RWFromFile(c_path_str, "rb");
+void AssetManager::unload_level_data(const string& id) {
+	// if the texture wasn't found
+	if (levels.find(id) == levels.end()) return;
+	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Unloading level data with id '%s'...\n", id.c_str());
 
-	if (!io) {
-		auto sdl_error = SDL_GetError();
-		log_error("AssetManager: Couldn't load level data on path '%s'! Error: %s.\n", c_path_str, sdl_error);
-		throw AMAssetLoadException(sdl_error);
-		return;
+	// we don't need the background anymore, unload it
+	take_background_prefetch(id);
+	unload_level_background(id);
+
+	// erase the record of said texture
+	levels.erase(id);
+}
+
+AssetManager::QueuedLoad AssetManager::make_level_background_load(const string& id, const string& background_path, const bool& reload) {
+	log_verbose("AssetManager: Loading the background of level '%s' on path '%s'...\n", id.c_str(), background_path.c_str());
+
+	auto decoded = make_shared<DecodedImage>();
+
+	auto record = make_shared<AssetLoadRecord>();
+	record->id = id;
+	record->kind = "background";
+
+	return {
+		record,
+		[=, this]() {
+			SDL_RWops* io = open_asset(background_path);
+			if (io)
+				decoded->bytes_read = static_cast<Uint64>(SDL_RWsize(io));
+			decoded->surface = io ? IMG_Load_RW(io, 1) : nullptr;
+			if (!decoded->surface) {
+				auto sdl_error = IMG_GetError();
+				log_error("AssetManager: Couldn't load image from path '%s'! Error: %s\n", background_path.c_str(), sdl_error);
+				throw AMAssetLoadException(sdl_error);
+			}
+		},
+		[=, this](SDL_Renderer* renderer) {
+			// the level could be unloaded while it's background was decoding
+			auto level = levels.find(id);
+			auto existing = cached_backgrounds.find(id);
+			if (level == levels.end() || (existing != cached_backgrounds.end() && !reload)) return false;
+
+			SDL_Texture* texture = upload_surface(renderer, decoded->surface, background_path);
+			Texture texture_obj(static_cast<ushort>(decoded->surface->w), static_cast<ushort>(decoded->surface->h), texture);
+			Uint64 bytes = static_cast<Uint64>(decoded->surface->w) * decoded->surface->h * 4;
+
+			if (existing != cached_backgrounds.end()) {
+				textures.at(id).replace(texture_obj);
+				background_bytes -= existing->second.bytes;
+				existing->second.bytes = bytes;
+				background_bytes += bytes;
+
+				record->bytes_read = decoded->bytes_read;
+				record->gpu_bytes = bytes;
+				return true;
+			}
+
+			textures.insert_or_assign(id, move(texture_obj));
+			level->second.background = &get_texture(id);
+
+			CachedBackground& cached = cached_backgrounds[id];
+			cached.bytes = bytes;
+			background_lru.push_front(id);
+			cached.lru_position = background_lru.begin();
+			background_bytes += cached.bytes;
+
+			record->bytes_read = decoded->bytes_read;
+			record->gpu_bytes = cached.bytes;
+			return true;
+		}
+	};
+}
+
+Texture* AssetManager::acquire_level_background(const string& id, SDL_Renderer* renderer) {
+	LevelData& data = get_level_data(id);
+
+	if (cached_backgrounds.find(id) == cached_backgrounds.end()) {
+		// a prefetch that's still decoding is waited for instead of decoding the background again,
+		// if it failed the background is loaded here, throwing the error this time
+		optional<QueuedLoad> prefetched = take_background_prefetch(id);
+		if (!prefetched) {
+			prefetched = make_level_background_load(id, data.background_path);
+			decode_load(*prefetched);
+		}
+		finish_load(*prefetched, renderer);
 	}
 
-	LevelData level_data;
+	cached_backgrounds.at(id).pin_count++;
+	touch_background(id);
+	evict_backgrounds();
 
-	auto level_doc_size = SDL_RWsize(io);
-	void* level_doc_bits = malloc(level_doc_size * sizeof(Sint64));
+	return data.background;
+}
 
-	SDL_RWread(io, level_doc_bits, level_doc_size, 1);
+void AssetManager::release_level_background(const string& id) {
+	auto cached = cached_backgrounds.find(id);
+	if (cached == cached_backgrounds.end() || cached->second.pin_count == 0) return;
 
-	pugi::xml_document level_doc;
-	pugi::xml_parse_result parse_res = level_doc.load_buffer(level_doc_bits, level_doc_size);
+	cached->second.pin_count--;
+	evict_backgrounds();
+}
 
-	if (!level_doc.child("level")) {
-		log_error("AssetManager: Invalid level data document on path '%s'!", c_path_str);
+void AssetManager::prefetch_level_background(const string& id) {
+	auto level = levels.find(id);
+	if (level == levels.end() || cached_backgrounds.find(id) != cached_backgrounds.end() || background_prefetches.find(id) != background_prefetches.end())
 		return;
+
+	// the decoding step only reads the background file, so it's safe to run on another thread
+	BackgroundPrefetch& prefetch = background_prefetches[id];
+	prefetch.load = make_level_background_load(id, level->second.background_path);
+	prefetch.decoded = async(launch::async, [load = prefetch.load]() mutable { decode_load(load); });
+}
+
+void AssetManager::finish_background_prefetches(SDL_Renderer* renderer) {
+	vector<string> ready;
+	for (auto& pair : background_prefetches) {
+		if (pair.second.decoded.wait_for(chrono::seconds(0)) == future_status::ready)
+			ready.push_back(pair.first);
 	}
 
-	pugi::xpath_node_set xp_points = level_doc.select_nodes("/level/point");
-	for (pugi::xpath_node xp_point : xp_points) {
-		float x = xp_point.node().attribute("x").as_float();
-		float y = xp_point.node().attribute("y").as_float();
-		level_data.track_points.push_back(vec2(x, y));
+	for (const string& id : ready) {
+		optional<QueuedLoad> prefetched = take_background_prefetch(id);
+		if (prefetched)
+			finish_load(*prefetched, renderer);
 	}
 
-	level_data.name = level_doc.select_node("/level/name").node().text().as_string();
+	if (!ready.empty())
+		evict_backgrounds();
+}
 
-	string bg_path_text = level_doc.select_node("/level/background/@src").attribute().as_string();
-	path bg_path = asset_path.parent_path();
-	bg_path /= bg_path_text;
+optional<AssetManager::QueuedLoad> AssetManager::take_background_prefetch(const string& id) {
+	auto prefetch = background_prefetches.find(id);
+	if (prefetch == background_prefetches.end()) return nullopt;
 
-	string bg_path_str = bg_path.string();
+	QueuedLoad load = move(prefetch->second.load);
+	future<void> decoded = move(prefetch->second.decoded);
+	background_prefetches.erase(prefetch);
 
-	SDL_Texture* texture = IMG_LoadTexture(renderer, bg_path_str.c_str());
-	if (!texture) {
-		auto sdl_error = IMG_GetError();
-		log_error("AssetManager: Couldn't load image from path '%s'! Error: %s\n", bg_path_str.c_str(), sdl_error);
-		throw AMAssetLoadException(sdl_error);
+	// the error is already logged, acquiring the background tries to load it again
+	try {
+		decoded.get();
+	}
+	catch (AMAssetLoadException&) {
+		return nullopt;
 	}
 
-	int texture_width = 0;
-	int texture_height = 0;
+	return load;
+}
 
-	SDL_QueryTexture(texture, nullptr, nullptr, &texture_width, &texture_height);
+void AssetManager::set_background_budget(Uint64 bytes) {
+	background_budget = bytes;
+	evict_backgrounds();
+}
 
-	Texture texture_obj(static_cast<ushort>(texture_width), static_cast<ushort>(texture_height), texture);
+void AssetManager::touch_background(const string& id) {
+	auto& cached = cached_backgrounds.at(id);
+	background_lru.splice(background_lru.begin(), background_lru, cached.lru_position);
+}
 
-	textures.insert({ id, move(texture_obj) });
+void AssetManager::evict_backgrounds() {
+	auto position = background_lru.end();
+	while (background_bytes > background_budget && position != background_lru.begin()) {
+		position--;
+		if (cached_backgrounds.at(*position).pin_count > 0)
+			continue;
+
+		// the unloaded background is removed from the list, so continue from the next one
+		string id = *position;
+		position++;
+		unload_level_background(id);
+	}
+}
 
-	level_data.background = &get_texture(id);
+void AssetManager::unload_level_background(const string& id) {
+	auto cached = cached_backgrounds.find(id);
+	if (cached == cached_backgrounds.end()) return;
+	log_verbose("AssetManager: Unloading the background of level '%s'...\n", id.c_str());
 
-	auto plpos_node = level_doc.select_node("/level/player-position").node();
-	level_data.player_position.x = plpos_node.attribute("x").as_float();
-	level_data.player_position.y = plpos_node.attribute("y").as_float();
+	background_bytes -= cached->second.bytes;
+	background_lru.erase(cached->second.lru_position);
+	cached_backgrounds.erase(cached);
 
-	level_data.track_ball_count = level_doc.select_node("/level/ball-count").node().text().as_uint();
-	level_data.track_speed_multiplier = level_doc.select_node("/level/speed-multiplier").node().text().as_float();
+	unload_texture(id);
+	auto level = levels.find(id);
+	if (level != levels.end())
+		level->second.background = nullptr;
+}
 
-	levels.insert({ id, move(level_data) });
+FontRegistry::~FontRegistry() {
+	for (auto& file : files)
+		for (auto& font : file.second.fonts)
+			TTF_CloseFont(font.second);
 }
 
-void AssetManager::unload_level_data(const string& id) {
-	// if the texture wasn't found
-	if (levels.find(id) == levels.end()) return;
-	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Unloading level data with id '%s'...\n", id.c_str());
+bool FontRegistry::has_file(const string& path) const { return files.find(path) != files.end(); }
 
-	// we don't need the texture anymore, unload it
-	unload_texture(id);
+void FontRegistry::add_file(const string& path, vector<Uint8>&& data) {
+	files[path].data = move(data);
+}
 
-	// erase the record of said texture
-	levels.erase(id);
+TTF_Font* FontRegistry::get_font(const string& path, const uint& pt_size, const uint& dpi) {
+	FontFile& file = files.at(path);
+
+	Uint64 key = static_cast<Uint64>(pt_size) << 32 | dpi;
+	auto cached = file.fonts.find(key);
+	if (cached != file.fonts.end())
+		return cached->second;
+
+	// the font reads the buffer while it's open, the SDL_RWops is freed when it's closed
+	SDL_RWops* io = SDL_RWFromConstMem(file.data.data(), static_cast<int>(file.data.size()));
+	TTF_Font* font = TTF_OpenFontDPIRW(io, 1, static_cast<int>(pt_size), dpi, dpi);
+	if (font == nullptr)
+		throw FontCreationException(TTF_GetError());
+
+	log_verbose("FontRegistry: Opened '%s' at %u pt and %u DPI.\n", path.c_str(), pt_size, dpi);
+	file.fonts.insert({ key, font });
+	return font;
 }
 
 void AssetManager::load_font(const string& id, const string& path, int font_size) {
@@ -359,14 +704,41 @@ void AssetManager::load_font(const string& id, const string& path, int font_size
 	auto c_path_str = constructed_path.c_str();
 	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Loading a font with id '%s' on path '%s'...\n", id.c_str(), c_path_str);
 
+	AssetLoadRecord record;
+	record.id = id;
+	record.kind = "font";
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	// the file is read once for all the fonts opened from it
+	if (!font_registry.has_file(constructed_path)) {
+		SDL_RWops* io = open_asset(constructed_path);
+		vector<Uint8> data(io ? static_cast<size_t>(max(SDL_RWsize(io), static_cast<Sint64>(0))) : 0);
+		bool is_read = io && !data.empty() && SDL_RWread(io, data.data(), data.size(), 1) == 1;
+		if (io)
+			SDL_RWclose(io);
+
+		if (!is_read) {
+			auto sdl_error = SDL_GetError();
+			log_error("AssetManager: Couldn't read font %s! Error: %s\n", c_path_str, sdl_error);
+			throw AMAssetLoadException(sdl_error);
+		}
+
+		record.bytes_read = data.size();
+		font_registry.add_file(constructed_path, move(data));
+	}
+
 	try {
-		Font font(c_path_str, font_size);
+		Font font(&font_registry, constructed_path, font_size);
 		fonts.insert({ id, font });
 	}
 	catch (FontCreationException e) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load font %s! Error: %s\n", c_path_str, e.what());
 		throw AMAssetLoadException(e.what());
 	}
+
+	// fonts are rasterized when text is rendered, so there's nothing uploaded here
+	record.decode_ms = (SDL_GetPerformanceCounter() - start) * 1000 / static_cast<double>(SDL_GetPerformanceFrequency());
+	load_records.push_back(move(record));
 }
 
 void AssetManager::unload_font(const string& id) {
@@ -376,36 +748,72 @@ void AssetManager::unload_font(const string& id) {
 	fonts.erase(id);
 }
 
+AssetManager::QueuedLoad AssetManager::make_audio_load(const string& id, const string& path, const AudioType& audio_type) {
+	// construct the path string
+	auto constructed_path = string(prefix) + path;
+	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Loading audio with id '%s' on path '%s'...\n", id.c_str(), constructed_path.c_str());
+
+	auto decoded = make_shared<DecodedAudio>();
+
+	auto record = make_shared<AssetLoadRecord>();
+	record->id = id;
+	record->kind = "audio";
+
+	return {
+		record,
+		// loading only creates the chunk or music object and doesn't touch
+		// the mixer's playback state, so it's safe to do on worker threads
+		[=, this]() {
+			auto c_path_str = constructed_path.c_str();
+
+			// music is streamed while playing, so it keeps reading from the pack's mapped memory
+			SDL_RWops* io = open_asset(constructed_path);
+			if (io)
+				record->bytes_read = static_cast<Uint64>(SDL_RWsize(io));
+			if (io && audio_type == Sound)
+				decoded->chunk = Mix_LoadWAV_RW(io, 1);
+			else if (io)
+				decoded->music = Mix_LoadMUS_RW(io, 1);
+
+			if (decoded->chunk == nullptr && decoded->music == nullptr) {
+				auto sdl_error = Mix_GetError();
+				SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load audio %s! Error: %s\n", c_path_str, sdl_error);
+				throw AMAssetLoadException(sdl_error);
+			}
+		},
+		[=, this](SDL_Renderer*) {
+			// the same audio could be queued twice
+			if (audio.find(id) != audio.end()) return false;
+
+			// the Audio object owns the chunk or music from now on
+			if (audio_type == Sound) {
+				Audio audio_obj(decoded->chunk);
+				audio.insert({ id, move(audio_obj) });
+			}
+			else {
+				Audio audio_obj(decoded->music);
+				audio.insert({ id, move(audio_obj) });
+			}
+
+			decoded->chunk = nullptr;
+			decoded->music = nullptr;
+			return true;
+		}
+	};
+}
+
 void AssetManager::load_audio(const string& id, const string& path, AudioType audio_type) {
 	// the asset is already loaded, there's no need to load it again
 	if (audio.find(id) != audio.end()) return;
 
-	// construct the path string
-	auto constructed_path = string(prefix) + path;
-	auto c_path_str = constructed_path.c_str();
-	SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "AssetManager: Loading audio with id '%s' on path '%s'...\n", id.c_str(), c_path_str);
-
-	Mix_Chunk* chunk = nullptr;
-	Mix_Music* music = nullptr;
-	if (audio_type == Sound)
-		chunk = Mix_LoadWAV(c_path_str);
-	else
-		music = Mix_LoadMUS(c_path_str);
-
-	if (chunk == nullptr && music == nullptr) {
-		auto sdl_error = Mix_GetError();
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load audio %s! Error: %s\n", c_path_str, sdl_error);
-		throw AMAssetLoadException(sdl_error);
-	}
+	QueuedLoad load = make_audio_load(id, path, audio_type);
+	decode_load(load);
+	finish_load(load, nullptr);
+}
 
-	if (audio_type == Sound) {
-		Audio audio_obj(chunk);
-		audio.insert({ id, move(audio_obj) });
-	}
-	else {
-		Audio audio_obj(music);
-		audio.insert({ id, move(audio_obj) });
-	}
+void AssetManager::queue_audio(const string& id, const string& path, AudioType audio_type) {
+	if (audio.find(id) != audio.end()) return;
+	queued_loads.push_back(make_audio_load(id, path, audio_type));
 }
 
 void AssetManager::unload_audio(const string& id) {
@@ -418,10 +826,171 @@ void AssetManager::unload_audio(const string& id) {
 }
 
 void AssetManager::load_all_levels(SDL_Renderer* renderer) {
-	filesystem::directory_iterator level_dir(string(prefix) + "/assets/levels");
-	for (const auto& entry : level_dir) {
-		if (entry.is_regular_file() && entry.path().extension() == ".xml") {
-			load_level_data(entry.path().stem().string(), entry.path().string(), renderer);
+	queue_all_levels();
+	load_queued(renderer);
+}
+
+void AssetManager::queue_all_levels() {
+	// a compiled level is loaded instead of the level XML with the same name
+	map<string, path> level_paths;
+	auto add_level = [&](const path& level_path) {
+		string extension = level_path.extension().string();
+		string id = level_path.stem().string();
+		if (extension == ".calev" || (extension == ".xml" && level_paths.find(id) == level_paths.end()))
+			level_paths[id] = level_path;
+	};
+
+	// with a pack, the levels are found in it's index instead of the directory
+	if (pack) {
+		const string levels_directory = "assets/levels/";
+		for (const AssetPack::Entry& entry : pack->get_entries()) {
+			if (entry.name.substr(0, levels_directory.size()) == levels_directory)
+				add_level(path(prefix) / path(entry.name));
+		}
+	}
+	else {
+		filesystem::directory_iterator level_dir(string(prefix) + "/assets/levels");
+		for (const auto& entry : level_dir) {
+			if (entry.is_regular_file())
+				add_level(entry.path());
 		}
 	}
+
+	for (const auto& pair : level_paths)
+		queue_level_data(pair.first, pair.second);
+}
+
+void AssetManager::decode_load(QueuedLoad& load) {
+	Uint64 start = SDL_GetPerformanceCounter();
+	load.decode();
+	load.record->decode_ms = (SDL_GetPerformanceCounter() - start) * 1000 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+bool AssetManager::finish_load(QueuedLoad& load, SDL_Renderer* renderer) {
+	Uint64 start = SDL_GetPerformanceCounter();
+	bool loaded = load.finish(renderer);
+	load.record->upload_ms = (SDL_GetPerformanceCounter() - start) * 1000 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+	if (loaded)
+		load_records.push_back(*load.record);
+	return loaded;
+}
+
+void AssetManager::load_queued(SDL_Renderer* renderer) {
+	// loads queued while loading (there are none now) are left for the next call
+	vector<QueuedLoad> loads;
+	loads.swap(queued_loads);
+
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	// if decoding fails, the exception is rethrown here after every other load is decoded,
+	// and the decoded data is released along with the loads
+	WorkerPool& pool = WorkerPool::get();
+	pool.parallel_for(static_cast<uint>(loads.size()), [&](uint i) { decode_load(loads[i]); });
+
+	Uint64 decoded = SDL_GetPerformanceCounter();
+
+	// textures can only be created on the render thread
+	for (QueuedLoad& load : loads)
+		finish_load(load, renderer);
+
+	Uint64 end = SDL_GetPerformanceCounter();
+	double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+
+	log_info(
+		"AssetManager: Loaded %u queued assets in %.1f ms (decoding on %u threads %.1f ms, uploading %.1f ms).\n",
+		static_cast<uint>(loads.size()),
+		(end - start) * 1000 / frequency,
+		pool.get_thread_count() + 1,
+		(decoded - start) * 1000 / frequency,
+		(end - decoded) * 1000 / frequency
+	);
+}
+
+const vector<AssetLoadRecord>& AssetManager::get_load_records() const { return load_records; }
+
+void AssetManager::log_load_report() const {
+	vector<const AssetLoadRecord*> sorted;
+	sorted.reserve(load_records.size());
+	for (const AssetLoadRecord& record : load_records)
+		sorted.push_back(&record);
+
+	// the slowest loads come first
+	sort(sorted.begin(), sorted.end(), [](const AssetLoadRecord* a, const AssetLoadRecord* b) {
+		return a->decode_ms + a->upload_ms > b->decode_ms + b->upload_ms;
+	});
+
+	log_info("AssetManager: Load report, %u assets, slowest first:\n", static_cast<uint>(sorted.size()));
+	log_info("  %-24s %-10s %10s %10s %10s %10s\n", "id", "kind", "read KiB", "decode ms", "upload ms", "GPU KiB");
+
+	AssetLoadRecord total;
+	for (const AssetLoadRecord* record : sorted) {
+		log_info(
+			"  %-24s %-10s %10.1f %10.2f %10.2f %10.1f\n",
+			record->id.c_str(), record->kind,
+			record->bytes_read / 1024.0, record->decode_ms, record->upload_ms, record->gpu_bytes / 1024.0
+		);
+
+		total.bytes_read += record->bytes_read;
+		total.decode_ms += record->decode_ms;
+		total.upload_ms += record->upload_ms;
+		total.gpu_bytes += record->gpu_bytes;
+	}
+
+	// decoding of queued loads overlaps, so the decode total is the summed work, not the elapsed time
+	log_info(
+		"  %-24s %-10s %10.1f %10.2f %10.2f %10.1f\n",
+		"total", "",
+		total.bytes_read / 1024.0, total.decode_ms, total.upload_ms, total.gpu_bytes / 1024.0
+	);
+}
+
+string AssetManager::get_source_key(const string& file_path) {
+	return path(file_path).lexically_normal().generic_string();
+}
+
+uint AssetManager::reload_asset(const string& file_path, SDL_Renderer* renderer) {
+	string key = get_source_key(file_path);
+
+	vector<AssetSource> sources;
+	auto range = asset_sources.equal_range(key);
+	for (auto it = range.first; it != range.second; it++)
+		sources.push_back(it->second);
+
+	// a level loaded from it's compiled file is reloaded from the level XML when the XML is edited
+	path file(key);
+	string level_id = file.stem().string();
+	if (sources.empty() && file.extension() == ".xml" && file.parent_path().filename() == "levels" && levels.find(level_id) != levels.end())
+		sources.push_back({ ATLevel, level_id, file_path });
+
+	uint reloaded = 0;
+	for (const AssetSource& source : sources) {
+		Uint64 start = SDL_GetPerformanceCounter();
+
+		// the asset could've been unloaded since it was loaded from the file
+		QueuedLoad load;
+		if (source.type == ATTexture && textures.find(source.id) != textures.end())
+			load = make_texture_load(source.id, source.load_path, true);
+		else if (source.type == ATUITexture && ui_textures.find(source.id) != ui_textures.end())
+			load = make_ui_texture_load(source.id, source.load_path, true);
+		else if (source.type == ATLevel && levels.find(source.id) != levels.end())
+			load = make_level_data_load(source.id, source.load_path, true);
+		else
+			continue;
+
+		decode_load(load);
+		if (!finish_load(load, renderer)) {
+			log_warn("AssetManager: Couldn't reload %s '%s' from '%s'.\n", load.record->kind, source.id.c_str(), key.c_str());
+			continue;
+		}
+		reloaded++;
+
+		log_info(
+			"AssetManager: Reloaded %s '%s' from '%s' in %.1f ms.\n",
+			load.record->kind, source.id.c_str(), key.c_str(),
+			(SDL_GetPerformanceCounter() - start) * 1000 / static_cast<double>(SDL_GetPerformanceFrequency())
+		);
+	}
+
+	return reloaded;
 }
@@ -15,6 +15,16 @@
 #include "Audio.h"
 #include <pugixml.hpp>
 #include <filesystem>
+#include <functional>
+#include <optional>
+#include <array>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <future>
+#include "WorkerPool.h"
+#include "AssetPack.h"
+#include "RawTexture.h"
 
 // #ifdef NDEBUG
 #define prefix "./"
@@ -26,7 +36,8 @@ using namespace std;
 using namespace filesystem;
 
 class AMAssetLoadException : public exception {
-	const char* msg;
+	// the message is copied, as SDL's error strings are overwritten by the next error
+	string msg;
 public:
 	AMAssetLoadException(const char* msg);
 	const char* what();
@@ -37,15 +48,46 @@ class AMAssetNotRegisteredException : public exception {};
 enum AssetType {
 	ATTexture,
 	ATUITexture,
-	ATLevel
+	ATLevel,
+	// texture stored as raw pixels instead of a PNG, see RawTextureHeader
+	ATRawTexture,
+	// not one of the asset formats, but a plain file (PNG, XML, audio...) inside an asset pack
+	ATFile = 0xFF
 };
 
 struct FontCreationException : public runtime_error {
 	FontCreationException(const char* msg) : runtime_error(msg) {}
 };
 
+// reads each font file once and keeps the fonts opened from it for every size and DPI,
+// so fonts from the same file and scaling changes don't read and parse the file again
+class FontRegistry {
+	struct FontFile {
+		// the fonts read from this buffer while they're open
+		vector<Uint8> data;
+		// keyed by the point size in the high half and the DPI in the low half
+		unordered_map<Uint64, TTF_Font*> fonts;
+	};
+	unordered_map<string, FontFile> files;
+
+public:
+	FontRegistry() = default;
+	~FontRegistry();
+
+	FontRegistry(const FontRegistry&) = delete;
+	FontRegistry& operator=(const FontRegistry&) = delete;
+
+	bool has_file(const string& path) const;
+	void add_file(const string& path, vector<Uint8>&& data);
+
+	// returns the font of the size and DPI from the added file, opening it the first time,
+	// throws FontCreationException if it couldn't be opened
+	TTF_Font* get_font(const string& path, const uint& pt_size, const uint& dpi);
+};
+
 class Font {
 	static const uint BASE_DPI = 96;
+	FontRegistry* registry;
 	string path;
 	TTF_Font* font = nullptr;
 	uint pt_size;
@@ -56,20 +98,19 @@ class Font {
 			return;
 
 		scaling = font_scaling;
-		destroy();
 
 		uint resulting_dpi =
 			static_cast<uint>(
 				static_cast<float>(BASE_DPI) * scaling
 			);
 
-		font = TTF_OpenFontDPI(path.c_str(), pt_size, resulting_dpi, resulting_dpi);
-		if (font == nullptr)
-			throw FontCreationException(TTF_GetError());
+		// the font is owned by the registry, which keeps it for when the scaling changes back
+		font = registry->get_font(path, pt_size, resulting_dpi);
 	}
 
 public:
-	Font(const string& path, const uint& pt_size) : path(path), pt_size(pt_size) {
+	// the font file must be added to the registry before
+	Font(FontRegistry* registry, const string& path, const uint& pt_size) : registry(registry), path(path), pt_size(pt_size) {
 		open_font();
 	}
 
@@ -80,28 +121,148 @@ public:
 		return new Texture(surface->w, surface->h, texture);
 	}
 
+	// the font is closed by the registry
 	void destroy() {
-		if (font)
-			TTF_CloseFont(font);
+		font = nullptr;
 	}
 };
 
+// timing and sizes of a single asset load, for the load report
+struct AssetLoadRecord {
+	string id;
+	// "texture", "ui texture", "level", "background", "font" or "audio"
+	const char* kind = "";
+	Uint64 bytes_read = 0;
+	double decode_ms = 0;
+	double upload_ms = 0;
+	// size of the created textures, at 4 bytes per pixel
+	Uint64 gpu_bytes = 0;
+};
+
 // AssetManager is the central place for loading and retrieving textures and other assets
 class AssetManager {
+	// declared first, so it's unmapped last, after the assets that may still read from it
+	unique_ptr<AssetPack> pack;
+
 	unordered_map<string, Texture> textures;
 	unordered_map<string, UITexture> ui_textures;
 	unordered_map<string, LevelData> levels;
+	// declared before the fonts, so the fonts are closed after the handles to them are gone
+	FontRegistry font_registry;
 	unordered_map<string, Font> fonts;
 	unordered_map<string, Audio> audio;
 
+	// a load split into decoding, which only touches the loaded file and it's decoded data,
+	// so it can run on a worker thread, and finishing, which creates textures
+	// and registers the asset, so it runs on the render thread
+	struct QueuedLoad {
+		// filled in by both steps and kept in load_records once the load is finished
+		shared_ptr<AssetLoadRecord> record;
+		function<void(void)> decode;
+		// returns false if the asset wasn't registered, as it's already loaded or invalid
+		function<bool(SDL_Renderer*)> finish;
+	};
+
+	// decoded data shared by the two steps of a load, freed with the load if it wasn't taken
+	struct DecodedImage {
+		SDL_Surface* surface = nullptr;
+		Uint64 bytes_read = 0;
+		// the surface holds raw texture pixels, which are uploaded without conversion
+		bool is_raw = false;
+		bool is_premultiplied = false;
+		~DecodedImage() { if (surface) SDL_FreeSurface(surface); }
+	};
+
+	struct DecodedAudio {
+		Mix_Chunk* chunk = nullptr;
+		Mix_Music* music = nullptr;
+		~DecodedAudio() {
+			if (chunk) Mix_FreeChunk(chunk);
+			if (music) Mix_FreeMusic(music);
+		}
+	};
+
+	vector<QueuedLoad> queued_loads;
+	vector<AssetLoadRecord> load_records;
+
+	// the assets loaded from each file, for reloading them when the file changes
+	struct AssetSource {
+		AssetType type;
+		string id;
+		// the path given when the asset was loaded
+		string load_path;
+	};
+	// keyed by the normalized path of the file
+	unordered_multimap<string, AssetSource> asset_sources;
+	static string get_source_key(const string& file_path);
+
+	// level backgrounds are loaded when a level needs them and stay cached,
+	// least recently used first to be unloaded, while they fit in the budget
+	struct CachedBackground {
+		list<string>::iterator lru_position;
+		Uint64 bytes = 0;
+		// pinned backgrounds are in use by a level and are never unloaded
+		uint pin_count = 0;
+	};
+
+	unordered_map<string, CachedBackground> cached_backgrounds;
+	// level ids of the cached backgrounds, the most recently used first
+	list<string> background_lru;
+	Uint64 background_bytes = 0;
+	Uint64 background_budget = DEFAULT_BACKGROUND_BUDGET;
+
+	// backgrounds being decoded on a separate thread, finished by finish_background_prefetches()
+	struct BackgroundPrefetch {
+		QueuedLoad load;
+		future<void> decoded;
+	};
+	unordered_map<string, BackgroundPrefetch> background_prefetches;
+
 	static bool is_signature_valid(const unsigned char* signature_data);
 	float convert_float_type(unsigned char* data);
 	uint convert_uint_type(unsigned char* data);
 
+	// reads the asset header into header and decodes the image that follows it,
+	// a raw texture is accepted where a texture is expected. throws AMAssetLoadException on errors
+	void decode_asset_image(const string& file_path, const AssetType& expected_type, unsigned char* header, const size_t& header_size, DecodedImage& decoded);
+	static SDL_Texture* upload_surface(SDL_Renderer* renderer, SDL_Surface* surface, const string& file_path);
+	// uploads raw texture pixels as they are, with the blend mode matching their alpha
+	static SDL_Texture* upload_raw_image(SDL_Renderer* renderer, DecodedImage& decoded, const string& file_path);
+
+	// runs the decoding step, timing it
+	static void decode_load(QueuedLoad& load);
+	// runs the finishing step, timing it and keeping the load's record, returns the result of the finishing step
+	bool finish_load(QueuedLoad& load, SDL_Renderer* renderer);
+
+	// a reload load replaces the loaded asset in place instead of skipping it
+	QueuedLoad make_texture_load(const string& id, const string& path, const bool& reload = false);
+	QueuedLoad make_ui_texture_load(const string& id, const string& path, const bool& reload = false);
+	QueuedLoad make_level_data_load(const string& id, const path& asset_path, const bool& reload = false);
+	QueuedLoad make_audio_load(const string& id, const string& path, const AudioType& audio_type);
+	QueuedLoad make_level_background_load(const string& id, const string& background_path, const bool& reload = false);
+
+	// marks the cached background as the most recently used
+	void touch_background(const string& id);
+	// unloads the least recently used unpinned backgrounds until the cache fits in the budget
+	void evict_backgrounds();
+	void unload_level_background(const string& id);
+	// waits for the prefetch to be decoded and removes it, returning it's load,
+	// or nullopt if the decoding failed
+	optional<QueuedLoad> take_background_prefetch(const string& id);
+
 public:
+	static constexpr Uint64 DEFAULT_BACKGROUND_BUDGET = 64 * 1024 * 1024;
+
 	AssetManager();
 	~AssetManager();
 
+	// maps the asset pack, assets found in it are read from it instead of separate files,
+	// returns false if the pack couldn't be opened
+	bool open_pack(const string& pack_path);
+	// opens the asset from the pack if it has the asset, or from the file otherwise,
+	// returns nullptr if neither exists
+	SDL_RWops* open_asset(const string& asset_path) const;
+
 	// gets the texture handle for the given texture id
 	Texture& get_texture(const string& id);
 
@@ -127,6 +288,40 @@ public:
 	void load_audio(const string& id, const string& path, AudioType audio_type = Sound);
 	void unload_audio(const string& id);
 
+	// loads the data of every level in the levels directory, without their backgrounds
 	void load_all_levels(SDL_Renderer* renderer);
+
+	// returns the level's background, loading it if it isn't cached, and pins it
+	// until it's released. throws AMAssetLoadException if it couldn't be loaded
+	Texture* acquire_level_background(const string& id, SDL_Renderer* renderer);
+	// unpins the level's background, it stays cached while it fits in the budget
+	void release_level_background(const string& id);
+	// starts decoding the level's background on a separate thread if it isn't cached,
+	// so acquiring it later doesn't wait for the decoding
+	void prefetch_level_background(const string& id);
+	// creates the textures of the prefetched backgrounds that finished decoding,
+	// must be called on the render thread
+	void finish_background_prefetches(SDL_Renderer* renderer);
+	// sets the size of the backgrounds to keep cached, at 4 bytes per pixel
+	void set_background_budget(Uint64 bytes);
+
+	// queue_* methods only remember the asset to load, load_queued() then decodes all
+	// of the queued assets in parallel on the worker pool and creates their textures
+	// on the calling thread, which must be the render thread
+	void queue_texture(const string& id, const string& path);
+	void queue_ui_texture(const string& id, const string& path);
+	void queue_level_data(const string& id, const path& asset_path);
+	void queue_audio(const string& id, const string& path, AudioType audio_type = Sound);
+	void queue_all_levels();
+	void load_queued(SDL_Renderer* renderer);
+
+	// reloads the textures, UI textures and levels loaded from the file in place, so their handles stay valid,
+	// returns the count of reloaded assets. throws AMAssetLoadException if the file couldn't be decoded
+	uint reload_asset(const string& file_path, SDL_Renderer* renderer);
+
+	// records of every load since the manager was created, in the order the loads finished
+	const vector<AssetLoadRecord>& get_load_records() const;
+	// logs the load records sorted by their total time, with totals
+	void log_load_report() const;
 	const unordered_map<string, LevelData>& get_levels() const { return levels; }
 };
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include "../engine/AssetPack.h"
+#include "../engine/AssetManager.h"
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace filesystem;
+
+static const char PACK_SIGNATURE[5] = { 'C', 'A', 'P', 'A', 'K' };
+static const size_t HEADER_SIZE = sizeof(PACK_SIGNATURE) + 1 + 4;
+
+AssetPack::AssetPack(const string& file_path) {
+	map_file(file_path);
+
+	try {
+		read_index();
+	}
+	catch (...) {
+		unmap_file();
+		throw;
+	}
+}
+
+AssetPack::~AssetPack() { unmap_file(); }
+
+#ifdef _WIN32
+void AssetPack::map_file(const string& file_path) {
+	HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw AssetPackException("couldn't open " + file_path);
+
+	LARGE_INTEGER file_size;
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr) {
+		if (mapping)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		throw AssetPackException("couldn't map " + file_path);
+	}
+
+	file_handle = file;
+	mapping_handle = mapping;
+	data = static_cast<const Uint8*>(view);
+	data_size = static_cast<size_t>(file_size.QuadPart);
+}
+
+void AssetPack::unmap_file() {
+	if (data)
+		UnmapViewOfFile(data);
+	if (mapping_handle)
+		CloseHandle(mapping_handle);
+	if (file_handle)
+		CloseHandle(file_handle);
+
+	data = nullptr;
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+}
+#else
+void AssetPack::map_file(const string& file_path) {
+	int file = ::open(file_path.c_str(), O_RDONLY);
+	if (file == -1)
+		throw AssetPackException("couldn't open " + file_path);
+
+	struct stat file_stat;
+	void* view = MAP_FAILED;
+	if (fstat(file, &file_stat) == 0 && file_stat.st_size > 0)
+		view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+	// the mapping stays valid after the file is closed
+	close(file);
+
+	if (view == MAP_FAILED)
+		throw AssetPackException("couldn't map " + file_path);
+
+	data = static_cast<const Uint8*>(view);
+	data_size = static_cast<size_t>(file_stat.st_size);
+}
+
+void AssetPack::unmap_file() {
+	if (data)
+		munmap(const_cast<Uint8*>(data), data_size);
+
+	data = nullptr;
+}
+#endif
+
+void AssetPack::read_index() {
+	if (data_size < HEADER_SIZE || memcmp(data, PACK_SIGNATURE, sizeof(PACK_SIGNATURE)) != 0)
+		throw AssetPackException("invalid signature");
+
+	if (data[5] != VERSION)
+		throw AssetPackException("unsupported version " + to_string(data[5]));
+
+	Uint32 entry_count = 0;
+	memcpy(&entry_count, data + 6, sizeof(entry_count));
+	entry_count = SDL_SwapLE32(entry_count);
+	size_t position = HEADER_SIZE;
+
+	// every read is checked against the mapped size, so a truncated pack can't be read past it's end
+	auto read = [&](void* out, size_t size) {
+		if (position + size > data_size)
+			throw AssetPackException("truncated index");
+		memcpy(out, data + position, size);
+		position += size;
+	};
+
+	entries.reserve(entry_count);
+	for (Uint32 i = 0; i < entry_count; i++) {
+		Uint16 name_length = 0;
+		read(&name_length, sizeof(name_length));
+		name_length = SDL_SwapLE16(name_length);
+
+		if (position + name_length > data_size)
+			throw AssetPackException("truncated index");
+		Entry entry;
+		entry.name = string_view(reinterpret_cast<const char*>(data + position), name_length);
+		position += name_length;
+
+		read(&entry.type, sizeof(entry.type));
+		read(&entry.offset, sizeof(entry.offset));
+		read(&entry.size, sizeof(entry.size));
+		entry.offset = SDL_SwapLE64(entry.offset);
+		entry.size = SDL_SwapLE64(entry.size);
+
+		if (entry.offset > data_size || entry.size > data_size - entry.offset)
+			throw AssetPackException("entry " + string(entry.name) + " is out of bounds");
+		// entries are opened as SDL memory streams, which have int sizes
+		if (entry.size > INT_MAX)
+			throw AssetPackException("entry " + string(entry.name) + " is too large");
+
+		if (!entries.empty() && entries.back().name >= entry.name)
+			throw AssetPackException("index isn't sorted");
+
+		entries.push_back(entry);
+	}
+}
+
+const AssetPack::Entry* AssetPack::find(const string_view& name) const {
+	auto it = lower_bound(
+		entries.begin(), entries.end(), name,
+		[](const Entry& entry, const string_view& name) { return entry.name < name; }
+	);
+
+	if (it == entries.end() || it->name != name)
+		return nullptr;
+
+	return &*it;
+}
+
+SDL_RWops* AssetPack::open(const string_view& name) const {
+	const Entry* entry = find(name);
+	if (entry == nullptr)
+		return nullptr;
+
+	// the RWops reads the mapped memory directly, nothing is copied
+	return SDL_RWFromConstMem(data + entry->offset, static_cast<int>(entry->size));
+}
+
+const vector<AssetPack::Entry>& AssetPack::get_entries() const { return entries; }
+
+// writes the value in little endian, returns false if it wasn't written
+template <typename T>
+static bool write_le(SDL_RWops* io, T value) {
+	Uint8 bytes[sizeof(T)];
+	for (size_t i = 0; i < sizeof(T); i++)
+		bytes[i] = static_cast<Uint8>(static_cast<Uint64>(value) >> (i * 8));
+	return SDL_RWwrite(io, bytes, sizeof(T), 1) == 1;
+}
+
+int AssetPack::build(const string& directory, const string& output_path) {
+	struct PackedFile {
+		string name;
+		path file_path;
+		Uint8 type = ATFile;
+		Uint64 offset = 0;
+		Uint64 size = 0;
+	};
+
+	vector<PackedFile> files;
+	for (const auto& entry : recursive_directory_iterator(directory)) {
+		if (!entry.is_regular_file())
+			continue;
+
+		PackedFile file;
+		file.name = entry.path().lexically_normal().generic_string();
+		file.file_path = entry.path();
+		file.size = entry.file_size();
+
+		// the asset files store their type after the signature
+		string extension = entry.path().extension().string();
+		if (extension == ".catex" || extension == ".cauit" || extension == ".calev") {
+			SDL_RWops* io = SDL_RWFromFile(file.file_path.string().c_str(), "rb");
+			Uint8 header[6];
+			if (io && SDL_RWread(io, header, sizeof(header), 1) == 1)
+				file.type = header[5];
+			if (io)
+				SDL_RWclose(io);
+		}
+
+		files.push_back(file);
+	}
+
+	sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) { return a.name < b.name; });
+
+	// lay out the blobs after the index
+	Uint64 offset = HEADER_SIZE;
+	for (const PackedFile& file : files)
+		offset += 2 + file.name.size() + 1 + 8 + 8;
+
+	for (PackedFile& file : files) {
+		offset = (offset + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+		file.offset = offset;
+		offset += file.size;
+	}
+
+	SDL_RWops* output = SDL_RWFromFile(output_path.c_str(), "wb");
+	if (output == nullptr) {
+		log_error("Couldn't open '%s' for writing! Error: %s\n", output_path.c_str(), SDL_GetError());
+		return 1;
+	}
+
+	// a partially written pack is deleted, so it can't be loaded later
+	auto fail_output = [&]() {
+		SDL_RWclose(output);
+		error_code error;
+		remove(path(output_path), error);
+		return 1;
+	};
+	auto fail_write = [&]() {
+		log_error("Couldn't write '%s'! Error: %s\n", output_path.c_str(), SDL_GetError());
+		return fail_output();
+	};
+
+	if (
+		SDL_RWwrite(output, PACK_SIGNATURE, sizeof(PACK_SIGNATURE), 1) != 1 ||
+		!write_le<Uint8>(output, VERSION) ||
+		!write_le<Uint32>(output, static_cast<Uint32>(files.size()))
+	)
+		return fail_write();
+
+	for (const PackedFile& file : files) {
+		if (
+			!write_le<Uint16>(output, static_cast<Uint16>(file.name.size())) ||
+			SDL_RWwrite(output, file.name.data(), file.name.size(), 1) != 1 ||
+			!write_le<Uint8>(output, file.type) ||
+			!write_le<Uint64>(output, file.offset) ||
+			!write_le<Uint64>(output, file.size)
+		)
+			return fail_write();
+	}
+
+	vector<Uint8> buffer;
+	for (const PackedFile& file : files) {
+		// pad up to the blob's offset
+		Sint64 position = SDL_RWtell(output);
+		if (position < 0 || static_cast<Uint64>(position) > file.offset)
+			return fail_write();
+
+		buffer.assign(static_cast<size_t>(file.offset - static_cast<Uint64>(position)), 0);
+		if (!buffer.empty() && SDL_RWwrite(output, buffer.data(), buffer.size(), 1) != 1)
+			return fail_write();
+
+		SDL_RWops* input = SDL_RWFromFile(file.file_path.string().c_str(), "rb");
+		buffer.resize(static_cast<size_t>(file.size));
+		if (input == nullptr || (file.size > 0 && SDL_RWread(input, buffer.data(), buffer.size(), 1) != 1)) {
+			log_error("Couldn't read '%s'! Error: %s\n", file.name.c_str(), SDL_GetError());
+			if (input)
+				SDL_RWclose(input);
+			return fail_output();
+		}
+		SDL_RWclose(input);
+
+		if (!buffer.empty() && SDL_RWwrite(output, buffer.data(), buffer.size(), 1) != 1)
+			return fail_write();
+		log_verbose("  %s (%llu bytes)\n", file.name.c_str(), static_cast<unsigned long long>(file.size));
+	}
+
+	// closing flushes the last buffered bytes, which can fail too
+	if (SDL_RWclose(output) != 0) {
+		log_error("Couldn't write '%s'! Error: %s\n", output_path.c_str(), SDL_GetError());
+		error_code error;
+		remove(path(output_path), error);
+		return 1;
+	}
+	log_info("Packed %u files from '%s' into '%s', %llu bytes.\n", static_cast<uint>(files.size()), directory.c_str(), output_path.c_str(), static_cast<unsigned long long>(offset));
+
+	return 0;
+}
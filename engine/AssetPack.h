@@ -0,0 +1,71 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdexcept>
+#include "common.h"
+
+using namespace std;
+
+struct AssetPackException : public runtime_error {
+	AssetPackException(const string& msg) : runtime_error(msg) {}
+};
+
+// AssetPack is a read-only archive of asset files (.capak), mapped into memory as a whole.
+//
+// file layout, numbers are little endian:
+//   header:  "CAPAK" signature, version (1 byte), entry count (4 bytes)
+//   index:   an entry per asset, sorted by name:
+//            name length (2 bytes), name, asset type (1 byte), offset (8 bytes), size (8 bytes)
+//   blobs:   the asset files as they are on disk, each aligned to BLOB_ALIGNMENT bytes
+//
+// entries are named by their path relative to the game directory, like "assets/menu_bg.catex"
+class AssetPack {
+public:
+	static const Uint8 VERSION = 1;
+	static const uint BLOB_ALIGNMENT = 16;
+
+	struct Entry {
+		// points into the mapped index
+		string_view name;
+		// the asset type from the asset's header, or ATFile for other files
+		Uint8 type;
+		Uint64 offset;
+		Uint64 size;
+	};
+
+private:
+	const Uint8* data = nullptr;
+	size_t data_size = 0;
+	vector<Entry> entries;
+
+#ifdef _WIN32
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#endif
+
+	void map_file(const string& file_path);
+	void unmap_file();
+	void read_index();
+
+public:
+	// maps the pack and reads it's index, throws AssetPackException if it can't be opened or is invalid
+	AssetPack(const string& file_path);
+	~AssetPack();
+
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+	// returns the entry by it's name, or nullptr if the pack doesn't have it
+	const Entry* find(const string_view& name) const;
+	// returns a read-only RWops over the asset's bytes in the mapped pack, or nullptr if the pack doesn't have it
+	SDL_RWops* open(const string_view& name) const;
+	// entries sorted by name
+	const vector<Entry>& get_entries() const;
+
+	// packs every file in the directory and it's subdirectories,
+	// entries are named by their path relative to the current directory.
+	// the results are logged and the return value is the process exit code
+	static int build(const string& directory, const string& output_path);
+};
@@ -0,0 +1,306 @@
+#include "../engine/Benchmarks.h"
+#include "../engine/Kernels.h"
+#include "../engine/AssetManager.h"
+#include "../engine/ParticlePool.h"
+#include "../engine/Sprite.h"
+#include "../game/Balls.h"
+#include <functional>
+#include <string>
+
+// runs the function the given number of times and returns the average time of one run in nanoseconds
+static double measure_ns(uint iterations, const function<void(void)>& func) {
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (uint i = 0; i < iterations; i++)
+		func();
+	Uint64 end = SDL_GetPerformanceCounter();
+
+	double seconds = static_cast<double>(end - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+	return seconds * 1e9 / iterations;
+}
+
+static void log_result(const string& name, double ns, uint elements, double reference_ns) {
+	log_info(
+		"  %-16s %10.1f ns/frame %8.3f ns/element %6.2fx\n",
+		name.c_str(), ns, ns / elements, reference_ns / ns
+	);
+}
+
+static void benchmark_particles() {
+	const uint COUNT = 2048;
+	const uint ITERATIONS = 20000;
+	const float DELTA = 1.0F / 60.0F;
+	const float GRAVITY = 100.0F;
+
+	log_info("Particle integration, %u particles:\n", COUNT);
+
+	// reference: the per-particle loop with particles stored as structures
+	struct Particle {
+		vec2 position;
+		vec2 velocity;
+	};
+	vector<Particle> particles(COUNT);
+	for (Particle& p : particles) {
+		p.position = vec2(rand_float() * WINDOW_WIDTH, rand_float() * WINDOW_HEIGHT);
+		p.velocity = vec2(rand_float() * 200 - 100, rand_float() * 200 - 100);
+	}
+
+	double reference_ns = measure_ns(ITERATIONS, [&]() {
+		for (Particle& p : particles) {
+			p.position.x += p.velocity.x * DELTA;
+			p.position.y += p.velocity.y * DELTA;
+			p.velocity.y += GRAVITY * DELTA;
+		}
+	});
+	log_result("reference (AoS)", reference_ns, COUNT, reference_ns);
+
+	vector<float> position_x(COUNT);
+	vector<float> position_y(COUNT);
+	vector<float> velocity_x(COUNT);
+	vector<float> velocity_y(COUNT);
+
+	for (const Kernels* kernels : Kernels::get_supported()) {
+		for (uint i = 0; i < COUNT; i++) {
+			position_x[i] = particles[i].position.x;
+			position_y[i] = particles[i].position.y;
+			velocity_x[i] = particles[i].velocity.x;
+			velocity_y[i] = particles[i].velocity.y;
+		}
+
+		double ns = measure_ns(ITERATIONS, [&]() {
+			kernels->integrate_particles(
+				position_x.data(), position_y.data(),
+				velocity_x.data(), velocity_y.data(),
+				COUNT, DELTA, GRAVITY
+			);
+		});
+		log_result(kernels->name, ns, COUNT, reference_ns);
+	}
+}
+
+static void benchmark_ball_transforms() {
+	const uint SEGMENT_COUNT = 100;
+	const uint BALL_COUNT = 1024;
+	const uint ITERATIONS = 20000;
+	const float SEGMENT_LENGTH = 25.0F;
+
+	log_info("Ball transforms, %u balls over %u track segments:\n", BALL_COUNT, SEGMENT_COUNT);
+
+	// a zigzag track with segments of equal length
+	TrackArrays track;
+	vector<float> lengths;
+	vec2 point;
+	for (uint i = 0; i < SEGMENT_COUNT; i++) {
+		float angle = (i % 2 == 0) ? 30.0F : -30.0F;
+
+		track.start_x.push_back(point.x);
+		track.start_y.push_back(point.y);
+		track.start_length.push_back(SEGMENT_LENGTH * i);
+		track.angle_cos.push_back(cosf(deg_to_rad(angle)));
+		track.angle_sin.push_back(sinf(deg_to_rad(angle)));
+		track.angle.push_back(normalize_angle(angle));
+		lengths.push_back(SEGMENT_LENGTH);
+
+		point.x += track.angle_cos.back() * SEGMENT_LENGTH;
+		point.y += track.angle_sin.back() * SEGMENT_LENGTH;
+	}
+
+	float total_length = SEGMENT_LENGTH * SEGMENT_COUNT;
+	vector<float> track_positions(BALL_COUNT);
+	for (uint i = 0; i < BALL_COUNT; i++)
+		track_positions[i] = total_length * i / BALL_COUNT;
+
+	vector<float> out_x(BALL_COUNT);
+	vector<float> out_y(BALL_COUNT);
+	vector<float> out_rotation(BALL_COUNT);
+
+	// reference: a linear search of the ball's track segment and a sum of the lengths
+	// before it for every ball, as the track update did it before the kernels
+	double reference_ns = measure_ns(ITERATIONS, [&]() {
+		for (uint i = 0; i < BALL_COUNT; i++) {
+			uint s = 0;
+			float current_length = lengths[0];
+			while (current_length < track_positions[i] && s < SEGMENT_COUNT - 1) {
+				s++;
+				current_length += lengths[s];
+			}
+
+			float total_sum = 0;
+			for (uint j = 0; j < s; j++)
+				total_sum += lengths[j];
+
+			float segment_position = track_positions[i] - total_sum;
+			out_x[i] = track.start_x[s] + track.angle_cos[s] * segment_position;
+			out_y[i] = track.start_y[s] + track.angle_sin[s] * segment_position;
+			out_rotation[i] = track.angle[s] + 90;
+		}
+	});
+	log_result("reference", reference_ns, BALL_COUNT, reference_ns);
+
+	// the kernels get the track segment indices precomputed,
+	// so the lookup is measured separately from the kernels
+	vector<uint> segment_indices(BALL_COUNT);
+	double lookup_ns = measure_ns(ITERATIONS, [&]() {
+		uint s = 0;
+		for (uint i = 0; i < BALL_COUNT; i++) {
+			while (s < SEGMENT_COUNT - 1 && track.start_length[s + 1] <= track_positions[i])
+				s++;
+			segment_indices[i] = s;
+		}
+	});
+	log_result("segment lookup", lookup_ns, BALL_COUNT, reference_ns);
+
+	for (const Kernels* kernels : Kernels::get_supported()) {
+		double ns = measure_ns(ITERATIONS, [&]() {
+			kernels->ball_transforms(
+				track,
+				track_positions.data(), segment_indices.data(), BALL_COUNT,
+				out_x.data(), out_y.data(), out_rotation.data()
+			);
+		});
+		log_result(kernels->name, ns, BALL_COUNT, reference_ns);
+	}
+}
+
+int run_kernel_benchmark() {
+	log_info("Running kernel benchmark, selected kernels: %s.\n", Kernels::get().name);
+
+	benchmark_particles();
+	benchmark_ball_transforms();
+
+	return 0;
+}
+
+// draws the benchmark scene: the menu background with the given count of rotated ball sprites
+// over it and a full particle pool on top, as the game draws a busy level
+static void draw_render_scene(
+	SDL_Renderer* renderer, const RendererState& renderer_state,
+	const Sprite& background, vector<Sprite>& balls, const ParticlePool& particles,
+	uint ball_count, uint frame
+) {
+	SDL_RenderClear(renderer);
+	background.draw(renderer, renderer_state);
+
+	for (uint i = 0; i < ball_count; i++) {
+		Sprite& ball = balls[i];
+		ball.global_transform.rotation = static_cast<float>((frame + i) % 360);
+		ball.draw(renderer, renderer_state);
+	}
+
+	particles.draw(renderer, renderer_state);
+	SDL_RenderPresent(renderer);
+}
+
+static void benchmark_renderer(SDL_Renderer* renderer, const string& name) {
+	const uint FRAMES = 200;
+	const uint BALL_COUNTS[] = { 250, 1000, 4000 };
+
+	log_info("Renderer '%s':\n", name.c_str());
+
+	// the textures belong to the renderer, so the assets are loaded for every renderer
+	AssetManager asset_manager;
+	try {
+		asset_manager.load_texture("menu_bg", "assets/menu_bg.catex", renderer);
+		asset_manager.load_texture("ball_red", "assets/ball_red.catex", renderer);
+		asset_manager.load_texture("ball_particle", "assets/ball_particle.catex", renderer);
+	}
+	catch (AMAssetLoadException ex) {
+		log_error("  Couldn't load the benchmark assets, skipping the renderer. Error: %s\n", ex.what());
+		return;
+	}
+
+	RendererState renderer_state;
+	Sprite background(&asset_manager.get_texture("menu_bg"));
+	background.set_display_size(vec2(WINDOW_WIDTH, WINDOW_HEIGHT));
+
+	Texture* ball_texture = &asset_manager.get_texture("ball_red");
+	int frame_w = ball_texture->get_width() / (Ball::BALL_ROTATION_FRAME_COUNT / Ball::BALL_SPRITESHEET_H);
+	int frame_h = ball_texture->get_height() / Ball::BALL_SPRITESHEET_H;
+
+	uint max_ball_count = BALL_COUNTS[size(BALL_COUNTS) - 1];
+	vector<Sprite> balls;
+	balls.reserve(max_ball_count);
+	for (uint i = 0; i < max_ball_count; i++) {
+		SDL_Rect clip_rect = { static_cast<int>(i % 10) * frame_w, static_cast<int>(i / 10 % 10) * frame_h, frame_w, frame_h };
+		balls.emplace_back(
+			ball_texture,
+			vec2(rand_float() * WINDOW_WIDTH, rand_float() * WINDOW_HEIGHT),
+			vec2(1, 1), 0, clip_rect, vec2(Ball::BALL_SIZE, Ball::BALL_SIZE)
+		);
+		balls.back().horizontal_alignment = Center;
+		balls.back().vertical_alignment = Middle;
+	}
+
+	ParticlePool particles(&asset_manager.get_texture("ball_particle"));
+	while (particles.emit(vec2(rand_float() * WINDOW_WIDTH, rand_float() * WINDOW_HEIGHT), vec2(), { 255, 200, 100, 255 }));
+
+	for (uint ball_count : BALL_COUNTS) {
+		// the first frame uploads the textures and isn't measured
+		draw_render_scene(renderer, renderer_state, background, balls, particles, ball_count, 0);
+
+		double frame_ns = measure_ns(FRAMES, [&, frame = 0u]() mutable {
+			draw_render_scene(renderer, renderer_state, background, balls, particles, ball_count, ++frame);
+		});
+
+		// background, balls and every particle quad
+		uint sprite_count = 1 + ball_count + particles.get_count();
+		log_info(
+			"  %5u balls + %u particles: %8.3f ms/frame %7.1f fps %12.0f sprites/s\n",
+			ball_count, particles.get_count(),
+			frame_ns / 1e6, 1e9 / frame_ns, sprite_count * 1e9 / frame_ns
+		);
+	}
+}
+
+int run_render_benchmark() {
+	// frames must not wait for the display, or every backend measures the refresh rate
+	SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+		log_error("SDL couldn't initialize! Error: %s\n", SDL_GetError());
+		return 1;
+	}
+	IMG_Init(IMG_INIT_PNG);
+
+	log_info("Running render benchmark at %dx%d.\n", WINDOW_WIDTH, WINDOW_HEIGHT);
+
+	for (int i = 0; i < SDL_GetNumRenderDrivers(); i++) {
+		SDL_RendererInfo info;
+		if (SDL_GetRenderDriverInfo(i, &info) != 0)
+			continue;
+
+		// a fresh window per driver, since SDL may recreate the window for an OpenGL context
+		SDL_Window* window = SDL_CreateWindow(
+			"Render Benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+			WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_HIDDEN
+		);
+		SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, i, 0) : nullptr;
+
+		if (renderer == nullptr)
+			log_warn("Renderer '%s': couldn't be created, skipping. Error: %s\n", info.name, SDL_GetError());
+		else
+			benchmark_renderer(renderer, info.name);
+
+		if (renderer)
+			SDL_DestroyRenderer(renderer);
+		if (window)
+			SDL_DestroyWindow(window);
+	}
+
+	// the software renderer drawing into a surface in memory, the path of machines without a working GPU driver
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+
+	if (renderer == nullptr)
+		log_warn("Renderer 'software (surface)': couldn't be created, skipping. Error: %s\n", SDL_GetError());
+	else
+		benchmark_renderer(renderer, "software (surface)");
+
+	if (renderer)
+		SDL_DestroyRenderer(renderer);
+	if (surface)
+		SDL_FreeSurface(surface);
+
+	IMG_Quit();
+	SDL_Quit();
+
+	return 0;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "LaunchOptions.h"
+
+// benchmarks are run instead of the game with their command line options,
+// the results are logged and the return value is the process exit code
+
+// compares every supported kernel set with the scalar loops they replaced
+int run_kernel_benchmark();
+
+// measures the frame time and sprite throughput of a busy scene on every available
+// render driver and on the software renderer drawing into an offscreen surface
+int run_render_benchmark();
@@ -47,8 +47,12 @@ void create_level_ui(shared_ptr<EntityManager> entity_manager, shared_ptr<AssetM
 	game_ui->root_element = game_flex;
 }
 
-Engine::Engine() {
+Engine::Engine(const LaunchOptions& options) : options(options) {
 	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
+	// nothing is heard in headless runs, and the machine running them may have no audio device,
+	// the SDL_AUDIODRIVER environment variable still takes precedence over this
+	if (options.headless)
+		SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
 		printf("SDL couldn't initialize! Error: %s\n", SDL_GetError());
 		return;
@@ -56,6 +60,12 @@ Engine::Engine() {
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SDL initialized.\n");
 
 	game_state.load_settings();
+
+	// headless runs draw the same frames regardless of the window settings
+	if (options.headless) {
+		game_state.renderer_state.scaling = 1;
+		game_state.renderer_state.is_fullscreen = false;
+	}
 	
 	window = SDL_CreateWindow(
 		"Catink Adventures", 
@@ -63,7 +73,7 @@ Engine::Engine() {
 		SDL_WINDOWPOS_CENTERED, 
 		static_cast<int>(Engine::WIDTH * this->game_state.renderer_state.scaling), 
 		static_cast<int>(Engine::HEIGHT * this->game_state.renderer_state.scaling), 
-		SDL_WINDOW_SHOWN
+		options.headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN
 	);
 
 	if (window == nullptr) {
@@ -72,18 +82,33 @@ Engine::Engine() {
 	}
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Window created with scale %f.\n", game_state.renderer_state.scaling);
 
-	set_fullscreen(game_state.renderer_state.is_fullscreen);
+	if (!options.headless)
+		set_fullscreen(game_state.renderer_state.is_fullscreen);
 
-	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+	// the command line option overrides the render driver from the settings
+	if (options.render_driver.empty())
+		create_renderer(game_state.renderer_state.render_driver);
+	else
+		create_renderer(options.render_driver);
 
 	if (renderer == nullptr) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create the renderer! Error: %s\n", SDL_GetError());
 		return;
 	}
-	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Renderer initialized.\n");
+
+	SDL_RendererInfo renderer_info;
+	SDL_GetRendererInfo(renderer, &renderer_info);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Renderer initialized with the '%s' driver.\n", renderer_info.name);
 
 	SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
 
+	game_state.renderer_state.integer_scaling = options.integer_scaling;
+	game_state.renderer_state.supersampling = options.supersampling;
+	create_frame_target();
+
+	if (!options.capture_frames.empty())
+		frame_capture = make_unique<FrameCapture>(options.capture_frames, options.capture_directory, options.capture_raw_path);
+
 	// Initialize SDL_Image
 	int img_flags = IMG_INIT_PNG;
 	if (!(IMG_Init(img_flags) & img_flags)) {
@@ -118,6 +143,9 @@ Engine::~Engine() {
 	for (auto handler : event_handlers)
 		delete handler;
 
+	if (frame_target)
+		SDL_DestroyTexture(frame_target);
+
 	SDL_DestroyWindow(window);
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Window destroyed.\n");
 }
@@ -127,11 +155,136 @@ void Engine::run_loop() {
 		entity_manager->delete_scheduled();
 		poll_events();
 
-		SDL_RenderClear(renderer);
+		begin_frame();
 		update();
 		draw();
-		SDL_RenderPresent(renderer);
+		present_frame();
+
+		if (options.frame_limit != 0 && frame_number >= options.frame_limit) {
+			log_info("Frame limit of %u reached, exiting.\n", options.frame_limit);
+			game_state.exit();
+		}
+	}
+}
+
+// returns the index of the render driver with the given name, or -1 if there's no such driver
+static int find_render_driver(const string& name) {
+	for (int i = 0; i < SDL_GetNumRenderDrivers(); i++) {
+		SDL_RendererInfo info;
+		if (SDL_GetRenderDriverInfo(i, &info) == 0 && name == info.name)
+			return i;
+	}
+
+	return -1;
+}
+
+void Engine::create_renderer(const string& render_driver) {
+	if (!render_driver.empty()) {
+		int driver_index = find_render_driver(render_driver);
+
+		// the software driver isn't accelerated, so only the render target support is required
+		if (driver_index != -1)
+			renderer = SDL_CreateRenderer(window, driver_index, SDL_RENDERER_TARGETTEXTURE);
+
+		if (renderer)
+			return;
+
+		log_warn("Couldn't create the renderer with the '%s' driver, letting SDL choose the driver.\n", render_driver.c_str());
 	}
+
+	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+}
+
+void Engine::create_frame_target() {
+	const RendererState& renderer_state = game_state.renderer_state;
+	int supersampling = renderer_state.supersampling;
+
+	frame_target = SDL_CreateTexture(
+		renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+		WIDTH * supersampling, HEIGHT * supersampling
+	);
+
+	// if the renderer can't draw into textures, let SDL scale every draw call instead
+	if (frame_target == nullptr) {
+		log_warn("Couldn't create the frame target, falling back to SDL logical size scaling. Error: %s\n", SDL_GetError());
+		SDL_RenderSetLogicalSize(renderer, WIDTH, HEIGHT);
+		SDL_RenderSetIntegerScale(renderer, renderer_state.integer_scaling ? SDL_TRUE : SDL_FALSE);
+		return;
+	}
+
+	// sharp pixels are the point of integer scaling, so the frame isn't filtered in that case
+	SDL_SetTextureScaleMode(frame_target, renderer_state.integer_scaling ? SDL_ScaleModeNearest : SDL_ScaleModeLinear);
+	log_info("Frame target created at %dx%d.\n", WIDTH * supersampling, HEIGHT * supersampling);
+}
+
+void Engine::begin_frame() {
+	frame_number++;
+
+	if (frame_target) {
+		SDL_SetRenderTarget(renderer, frame_target);
+		// the render scale is reset on every target change
+		float supersampling = static_cast<float>(game_state.renderer_state.supersampling);
+		SDL_RenderSetScale(renderer, supersampling, supersampling);
+	}
+
+	SDL_RenderClear(renderer);
+}
+
+// fits the logical resolution into the given size centered, keeping the aspect ratio
+static SDL_FRect fit_logical_rect(int w, int h, bool integer_scaling) {
+	float scale = fminf(static_cast<float>(w) / Engine::WIDTH, static_cast<float>(h) / Engine::HEIGHT);
+	if (integer_scaling && scale >= 1)
+		scale = floorf(scale);
+
+	SDL_FRect rect;
+	rect.w = Engine::WIDTH * scale;
+	rect.h = Engine::HEIGHT * scale;
+	rect.x = (w - rect.w) / 2;
+	rect.y = (h - rect.h) / 2;
+
+	return rect;
+}
+
+void Engine::present_frame() {
+	update_present_rect();
+
+	// the frame is captured from the frame target, before it's scaled to the window
+	if (frame_capture && frame_capture->should_capture(frame_number))
+		frame_capture->capture(renderer, frame_number);
+
+	if (frame_target) {
+		SDL_SetRenderTarget(renderer, nullptr);
+
+		int output_w = 0;
+		int output_h = 0;
+		SDL_GetRendererOutputSize(renderer, &output_w, &output_h);
+		SDL_FRect present_rect = fit_logical_rect(output_w, output_h, game_state.renderer_state.integer_scaling);
+
+		// letterbox with black, then restore the draw color for the next frame's clear
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+		SDL_RenderClear(renderer);
+		SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+
+		SDL_RenderCopyF(renderer, frame_target, nullptr, &present_rect);
+	}
+
+	SDL_RenderPresent(renderer);
+}
+
+void Engine::update_present_rect() {
+	RendererState& renderer_state = game_state.renderer_state;
+
+	int window_w = 0;
+	int window_h = 0;
+	SDL_GetWindowSize(window, &window_w, &window_h);
+
+	// mouse coordinates are in window coordinates, so the present rect is calculated
+	// in them too, and not in output pixels, which differ on high DPI displays
+	SDL_FRect window_rect = fit_logical_rect(window_w, window_h, renderer_state.integer_scaling);
+
+	renderer_state.scaling = window_rect.w / WIDTH;
+	renderer_state.window_size = vec2(static_cast<float>(window_w), static_cast<float>(window_h));
+	renderer_state.present_offset = vec2(window_rect.x, window_rect.y);
 }
 
 void Engine::poll_events() {
@@ -150,27 +303,58 @@ void Engine::add_event_handler(EventHandler* event_handler) {
 }
 
 void Engine::draw() {
+	const RendererState& renderer_state = game_state.renderer_state;
+	renderer_state.drawn_count = 0;
+	renderer_state.culled_count = 0;
+
+	// entities that wouldn't put anything on the screen aren't submitted to the renderer,
+	// entities drawing others (like BallTrack) cull them the same way
 	for (shared_ptr<Drawable> dr : entity_manager->get_entities_by_section(game_state.get_section())) {
-		dr->draw(renderer, game_state.renderer_state);
+		if (cull_drawable(*dr, renderer_state))
+			dr->draw(renderer, renderer_state);
 	}
 
 	for (shared_ptr<Drawable> dr : entity_manager->get_entities_by_section(None)) {
-		dr->draw(renderer, game_state.renderer_state);
+		if (cull_drawable(*dr, renderer_state))
+			dr->draw(renderer, renderer_state);
 	}
+
+	if (frame_number % DRAW_STATS_INTERVAL == 0)
+		log_verbose("Frame %u: %u drawn, %u culled.\n", frame_number, renderer_state.drawn_count, renderer_state.culled_count);
 }
 
 void Engine::update() {
-	float current_time = static_cast<float>(SDL_GetTicks()) / 1000.0F;
-	float delta = current_time - last_time;
-	last_time = current_time;
+	float delta = HEADLESS_FRAME_TIME;
+
+	// headless runs don't wait for frames and advance by a fixed delta,
+	// so every run simulates and draws the same frames
+	if (!options.headless) {
+		float current_time = static_cast<float>(SDL_GetTicks()) / 1000.0F;
+		delta = current_time - last_time;
+		last_time = current_time;
 
-	if (delta < max_frame_time) {
-		SDL_Delay(static_cast<uint>((max_frame_time - delta) * 1000));
+		if (delta < max_frame_time) {
+			SDL_Delay(static_cast<uint>((max_frame_time - delta) * 1000));
+		}
 	}
 
 	// reset mouse_on_ui state to prepare for the next UI update
 	game_state.mouse_state.mouse_on_ui = false;
 
+	asset_manager->finish_background_prefetches(renderer);
+
+	if (file_watcher) {
+		for (const string& file : file_watcher->get_changed_files()) {
+			// a file that's still being written or is broken keeps the loaded asset as it was
+			try {
+				asset_manager->reload_asset(file, renderer);
+			}
+			catch (AMAssetLoadException& e) {
+				log_warn("Couldn't reload '%s', keeping the loaded asset. Error: %s\n", file.c_str(), e.what());
+			}
+		}
+	}
+
 	vector<shared_ptr<Updatable>> updatables = entity_manager->get_entities_by_section_and_type<Updatable>(game_state.get_section());
 	for (auto updatable : updatables) {
 		updatable->update(delta, game_state);
@@ -217,6 +401,12 @@ void Engine::update() {
 	if (keyboard_timer)
 		keyboard_timer->update(delta, game_state);
 
+	// F9 logs the asset load report once per press
+	bool is_report_key_pressed = game_state.keyboard_state.keys && game_state.keyboard_state.keys[SDL_SCANCODE_F9];
+	if (is_report_key_pressed && !was_report_key_pressed)
+		asset_manager->log_load_report();
+	was_report_key_pressed = is_report_key_pressed;
+
 	if (game_state.keyboard_state.keys && game_state.keyboard_state.keys[SDL_SCANCODE_ESCAPE]) {
 		if (game_state.get_section() == InLevel) {
 			entity_manager->schedule_to_delete("level");
@@ -518,19 +708,14 @@ void Engine::prepare_level_select_ui() {
 				vec2(10, 10)
 			);
 
+		// the background is decoded while the button is hovered, so the level starts without waiting for it
+		select_button->add_event_listener(MouseEnter, "prefetch_level", [=, this](GameState&, auto) {
+			asset_manager->prefetch_level_background(data.first);
+		});
+
 		select_button->add_event_listener(LMBUp, "select_level", [=, this](GameState& gs, auto) {
 			gs.fade_in([=, &gs, this]() {
-				entity_manager->remove_entity("level");
-				entity_manager->add_entity(
-					"level",
-					make_shared<Level>(
-						&asset_manager->get_level_data(data.first),
-						asset_manager, entity_manager, renderer, create_level_ui
-					),
-					InLevel
-				);
-
-				current_level = data.first;
+				start_level(data.first);
 
 				gs.set_section(InLevel);
 				gs.fade_out([](){}, Fade::DURATION / 3);
@@ -743,7 +928,7 @@ void Engine::prepare_settings_ui() {
 		);
 
 	add_scaling_button->add_event_listener(LMBUp, "scaling_change", [=, this](GameState& game_state, auto) {
-		float new_scaling = clamp(game_state.renderer_state.scaling + 0.05F, 0.125F, 10.0F);
+		float new_scaling = clamp(game_state.renderer_state.saved_scaling + 0.05F, 0.125F, 10.0F);
 		//if (new_scaling > 10)
 		//	new_scaling = 10;
 		//if (new_scaling < 0.125)
@@ -756,7 +941,7 @@ void Engine::prepare_settings_ui() {
 	});
 
 	sub_scaling_button->add_event_listener(LMBUp, "scaling_change", [=, this](GameState& game_state, auto) {
-		float new_scaling = clamp(game_state.renderer_state.scaling - 0.05F, 0.125F, 10.0F);
+		float new_scaling = clamp(game_state.renderer_state.saved_scaling - 0.05F, 0.125F, 10.0F);
 		//if (new_scaling > 10)
 		//	new_scaling = 10;
 		//if (new_scaling < 0.125)
@@ -770,7 +955,39 @@ void Engine::prepare_settings_ui() {
 
 	scaling_buttons_flex->add_children({ add_scaling_button, sub_scaling_button });
 
-	flex->add_children({ caption_text, back_button, fullscreen_button, volume_text, volume_buttons_flex, scaling_text, scaling_buttons_flex });
+	auto get_render_driver_caption = [](const string& render_driver) {
+		return "Renderer: " + (render_driver.empty() ? string("Auto") : render_driver);
+	};
+
+	auto render_driver_button =
+		make_shared<Button>(
+			"render_driver_switch",
+			settings_ui,
+			&asset_manager->get_ui_texture("medieval_button"),
+			get_render_driver_caption(game_state.renderer_state.render_driver),
+			&asset_manager->get_font("medieval_button_font"),
+			SDL_Color({ 65, 45, 10 }),
+			BoundingBox(25, 15),
+			vec2(10, 10)
+		);
+
+	// cycles through automatic selection and every available render driver,
+	// the renderer can't be recreated with loaded textures, so it's applied on the next launch
+	render_driver_button->add_event_listener(LMBUp, "render_driver_change", [=](GameState& game_state, UIElement* el) {
+		auto button = dynamic_cast<Button*>(el);
+		string& render_driver = game_state.renderer_state.render_driver;
+
+		int next_index = render_driver.empty() ? 0 : find_render_driver(render_driver) + 1;
+		SDL_RendererInfo info;
+		if (next_index < SDL_GetNumRenderDrivers() && SDL_GetRenderDriverInfo(next_index, &info) == 0)
+			render_driver = info.name;
+		else
+			render_driver.clear();
+
+		button->set_text_content(get_render_driver_caption(render_driver));
+	});
+
+	flex->add_children({ caption_text, back_button, fullscreen_button, volume_text, volume_buttons_flex, scaling_text, scaling_buttons_flex, render_driver_button });
 
 	flex->update_layout(true);
 
@@ -781,38 +998,66 @@ void Engine::prepare_settings_ui() {
 
 void Engine::prepare() {
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Loading game assets...\n");
-	asset_manager->load_texture("player_normal", "assets/player_normal.catex", renderer);
-	asset_manager->load_texture("player_action", "assets/player_action.catex", renderer);
-	asset_manager->load_texture("ball_red", "assets/ball_red.catex", renderer);
-	asset_manager->load_texture("ball_blue", "assets/ball_blue.catex", renderer);
-	asset_manager->load_texture("ball_green", "assets/ball_green.catex", renderer);
-	asset_manager->load_texture("ball_purple", "assets/ball_purple.catex", renderer);
-	asset_manager->load_texture("ball_yellow", "assets/ball_yellow.catex", renderer);
-	asset_manager->load_texture("ball_gray", "assets/ball_gray.catex", renderer);
-	asset_manager->load_texture("ball_sheen", "assets/ball_sheen.catex", renderer);
-	asset_manager->load_texture("ball_particle", "assets/ball_particle.catex", renderer);
-
-	asset_manager->load_texture("black", "assets/black.catex", renderer);
-	asset_manager->load_texture("death_window", "assets/death_window.catex", renderer);
-
-	asset_manager->load_ui_texture("medieval_button", "assets/medieval_button.cauit", renderer);
+
+	// hot reloading reads the changed files, so the assets are loaded from files instead of the pack,
+	// a missing default pack isn't an error, the assets are loaded from files then too
+	if (options.hot_reload) {
+		file_watcher = make_unique<FileWatcher>(string(prefix) + "assets");
+		log_info("Hot reloading is enabled, the asset pack isn't used.\n");
+	}
+	else if (options.pack_path != LaunchOptions::DEFAULT_PACK_PATH || filesystem::exists(options.pack_path)) {
+		asset_manager->open_pack(options.pack_path);
+	}
+
+	asset_manager->set_background_budget(static_cast<Uint64>(options.background_budget) * 1024 * 1024);
+
+	// assets are queued and then decoded in parallel by load_queued(),
+	// fonts are loaded right away, as SDL_ttf can't open fonts from multiple threads
+	asset_manager->queue_texture("player_normal", "assets/player_normal.catex");
+	asset_manager->queue_texture("player_action", "assets/player_action.catex");
+
+	// either load one neutral spritesheet that is tinted per ball color,
+	// or a separate spritesheet for every ball color
+	Ball::use_tinted_sheet = options.tinted_balls;
+	if (Ball::use_tinted_sheet) {
+		asset_manager->queue_texture(BALL_TINTED_SHEET_TEXTURE, "assets/ball_gray.catex");
+	}
+	else {
+		asset_manager->queue_texture("ball_red", "assets/ball_red.catex");
+		asset_manager->queue_texture("ball_blue", "assets/ball_blue.catex");
+		asset_manager->queue_texture("ball_green", "assets/ball_green.catex");
+		asset_manager->queue_texture("ball_purple", "assets/ball_purple.catex");
+		asset_manager->queue_texture("ball_yellow", "assets/ball_yellow.catex");
+		asset_manager->queue_texture("ball_gray", "assets/ball_gray.catex");
+	}
+
+	asset_manager->queue_texture("ball_sheen", "assets/ball_sheen.catex");
+	asset_manager->queue_texture("ball_particle", "assets/ball_particle.catex");
+
+	asset_manager->queue_texture("black", "assets/black.catex");
+	asset_manager->queue_texture("death_window", "assets/death_window.catex");
+
+	asset_manager->queue_ui_texture("medieval_button", "assets/medieval_button.cauit");
 	asset_manager->load_font("medieval_button_font", "assets/BerkshireSwash-Regular.ttf", 24);
 	asset_manager->load_font("medieval_button_font_large", "assets/BerkshireSwash-Regular.ttf", 48);
 	//asset_manager->load_level_data("level1", "assets/level1.calev", renderer);
 	//asset_manager->load_level_data("level2", "assets/level2.calev", renderer);
-	asset_manager->load_all_levels(renderer);
+	asset_manager->queue_all_levels();
+
+	asset_manager->queue_texture("death_screen_bg", "assets/death_screen_bg.catex");
+	asset_manager->queue_texture("level_select_bg", "assets/level_select_bg.catex");
+	asset_manager->queue_texture("menu_bg", "assets/menu_bg.catex");
 
-	asset_manager->load_texture("death_screen_bg", "assets/death_screen_bg.catex", renderer);
-	asset_manager->load_texture("level_select_bg", "assets/level_select_bg.catex", renderer);
-	asset_manager->load_texture("menu_bg", "assets/menu_bg.catex", renderer);
+	asset_manager->queue_audio("ball_break", "assets/ball_break.wav", Sound);
+	asset_manager->queue_audio("ball_collision", "assets/ball_collision.wav", Sound);
+	asset_manager->queue_audio("ball_collision_pitched", "assets/ball_collision_pitched.wav", Sound);
 
-	asset_manager->load_audio("ball_break", "assets/ball_break.wav", Sound);
-	asset_manager->load_audio("ball_collision", "assets/ball_collision.wav", Sound);
-	asset_manager->load_audio("ball_collision_pitched", "assets/ball_collision_pitched.wav", Sound);
+	asset_manager->queue_audio("main_menu", "assets/main_menu.mp3", Music);
+	asset_manager->queue_audio("death_song", "assets/death_song.mp3", Music);
+	asset_manager->queue_audio("level_song", "assets/level_song.mp3", Music);
 
-	asset_manager->load_audio("main_menu", "assets/main_menu.mp3", Music);
-	asset_manager->load_audio("death_song", "assets/death_song.mp3", Music);
-	asset_manager->load_audio("level_song", "assets/level_song.mp3", Music);
+	asset_manager->load_queued(renderer);
+	asset_manager->log_load_report();
 
 	game_state.section_music = {
 		{ InMenu, asset_manager->get_audio("main_menu") },
@@ -840,8 +1085,17 @@ void Engine::prepare() {
 	prepare_level_select_ui();
 	prepare_settings_ui();
 
-	// set the default section to be InMenu
-	game_state.set_section(InMenu);
+	// set the default section to be InMenu, or start in the level given on the command line
+	const auto& levels = asset_manager->get_levels();
+	if (!options.level.empty() && levels.find(options.level) != levels.end()) {
+		start_level(options.level);
+		game_state.set_section(InLevel);
+	}
+	else {
+		if (!options.level.empty())
+			log_warn("Level '%s' isn't loaded, starting in the menu.\n", options.level.c_str());
+		game_state.set_section(InMenu);
+	}
 
 	// forward fade methods to the global game state
 	game_state.fade_out = [=](function<void(void)> callback, float duration = Fade::DURATION) { fade->fade_out(callback, duration); };
@@ -851,6 +1105,20 @@ void Engine::prepare() {
 	fade->fade_out([](){});
 }
 
+void Engine::start_level(const string& id) {
+	entity_manager->remove_entity("level");
+	entity_manager->add_entity(
+		"level",
+		make_shared<Level>(
+			&asset_manager->get_level_data(id),
+			asset_manager, entity_manager, renderer, create_level_ui
+		),
+		InLevel
+	);
+
+	current_level = id;
+}
+
 void Engine::change_window_size(int w, int h) {
 	SDL_SetWindowSize(window, w, h);
 }
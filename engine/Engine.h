@@ -7,6 +7,9 @@
 #include <unordered_map>
 #include <string>
 #include "AssetManager.h"
+#include "LaunchOptions.h"
+#include "FrameCapture.h"
+#include "FileWatcher.h"
 #include "EventHandler.h"
 #include "basics.h"
 #include "EntityManager.h"
@@ -29,10 +32,19 @@ class Engine {
 
 	SDL_Window* window = nullptr;
 	SDL_Renderer* renderer = nullptr;
+	// the frame is drawn into this texture at the logical resolution and scaled once on present
+	SDL_Texture* frame_target = nullptr;
 	GameState game_state;
+	LaunchOptions options;
 	float last_time = 0;
+	// number of the current frame, the first frame is 1
+	uint frame_number = 0;
+	unique_ptr<FrameCapture> frame_capture;
+	// watches the assets directory when hot reloading is enabled
+	unique_ptr<FileWatcher> file_watcher;
 
 	Timer* keyboard_timer = nullptr;
+	bool was_report_key_pressed = false;
 
 	string current_level;
 
@@ -41,6 +53,18 @@ class Engine {
 	void update();
 	void poll_events();
 	void change_window_size(int w, int h);
+	// replaces the current level entity with a new level from the level data with the given id
+	void start_level(const string& id);
+
+	// creates the renderer with the named render driver, or with the one SDL chooses
+	void create_renderer(const string& render_driver);
+	void create_frame_target();
+	// sets the frame target as the render target, everything drawn after is in logical coordinates
+	void begin_frame();
+	// scales the drawn frame to the window and presents it
+	void present_frame();
+	// calculates the scaling and offset of the presented frame by the current output size
+	void update_present_rect();
 
 	void prepare_death_ui();
 	void prepare_win_ui();
@@ -51,12 +75,15 @@ class Engine {
 public:
 	static const int WIDTH = 1280;
 	static const int HEIGHT = 720;
+	static constexpr float HEADLESS_FRAME_TIME = 1.0F / 60.0F;
+	// the drawn and culled counts are logged every this many frames
+	static const uint DRAW_STATS_INTERVAL = 300;
 
 	shared_ptr<AssetManager> asset_manager;
 	shared_ptr<EntityManager> entity_manager;
 	vector<EventHandler*> event_handlers;
 
-	Engine();
+	Engine(const LaunchOptions& options = LaunchOptions());
 	~Engine();
 
 	void run_loop();
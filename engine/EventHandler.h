@@ -17,10 +17,12 @@ public:
 				int mouse_y;
 				SDL_GetMouseState(&mouse_x, &mouse_y);
 				game_state.mouse_state.previous_mouse_pos = game_state.mouse_state.mouse_pos;
+				// convert window coordinates to the logical resolution
+				const RendererState& renderer_state = game_state.renderer_state;
 				game_state.mouse_state.mouse_pos =
 					vec2(
-						static_cast<float>(mouse_x) / game_state.renderer_state.scaling,
-						static_cast<float>(mouse_y) / game_state.renderer_state.scaling
+						(static_cast<float>(mouse_x) - renderer_state.present_offset.x) / renderer_state.scaling,
+						(static_cast<float>(mouse_y) - renderer_state.present_offset.y) / renderer_state.scaling
 					);
 				break;
 			}
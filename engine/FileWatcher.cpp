@@ -0,0 +1,125 @@
+#include "../engine/FileWatcher.h"
+#include <set>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace filesystem;
+
+FileWatcher::FileWatcher(const string& directory) : directory(directory) {
+#ifdef __linux__
+	inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotify_fd >= 0) {
+		add_watches(this->directory);
+		log_info("FileWatcher: Watching '%s' with inotify.\n", directory.c_str());
+		return;
+	}
+	log_warn("FileWatcher: Couldn't initialize inotify, polling '%s' instead. Error: %s\n", directory.c_str(), strerror(errno));
+#endif
+
+	// the current times are the ones the changes are compared to
+	read_write_times(nullptr);
+	last_poll = SDL_GetTicks64();
+	log_info("FileWatcher: Polling '%s' for changes.\n", directory.c_str());
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+	if (inotify_fd >= 0)
+		close(inotify_fd);
+#endif
+}
+
+void FileWatcher::add_watches(const path& watched_directory) {
+#ifdef __linux__
+	// editors either write the file in place or write a new file and move it over the old one
+	int watch = inotify_add_watch(inotify_fd, watched_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (watch < 0) {
+		log_warn("FileWatcher: Couldn't watch '%s'! Error: %s\n", watched_directory.c_str(), strerror(errno));
+		return;
+	}
+	watched_directories[watch] = watched_directory;
+
+	// inotify doesn't watch subdirectories, so each of them gets it's own watch
+	error_code error;
+	for (const auto& entry : directory_iterator(watched_directory, error)) {
+		if (entry.is_directory())
+			add_watches(entry.path());
+	}
+#endif
+}
+
+void FileWatcher::read_write_times(vector<string>* changed_files) {
+	error_code error;
+	for (const auto& entry : recursive_directory_iterator(directory, error)) {
+		if (!entry.is_regular_file())
+			continue;
+
+		string file = entry.path().generic_string();
+		file_time_type write_time = entry.last_write_time(error);
+		if (error)
+			continue;
+
+		auto known = write_times.find(file);
+		if (changed_files && (known == write_times.end() || known->second != write_time))
+			changed_files->push_back(file);
+		write_times[file] = write_time;
+	}
+}
+
+vector<string> FileWatcher::read_inotify_events() {
+	// the paths are kept ordered and unique, as saving a file often raises several events
+	set<string> changed_files;
+
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+	while (true) {
+		ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+		if (length <= 0)
+			break;
+
+		for (char* position = buffer; position < buffer + length;) {
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(position);
+			position += sizeof(inotify_event) + event->len;
+
+			auto watched = watched_directories.find(event->wd);
+			if (watched == watched_directories.end() || event->len == 0)
+				continue;
+
+			path event_path = watched->second / event->name;
+			if (event->mask & IN_ISDIR) {
+				if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					add_watches(event_path);
+			}
+			// a created file is reported once it's closed after writing
+			else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+				changed_files.insert(event_path.generic_string());
+			}
+		}
+	}
+#endif
+
+	return vector<string>(changed_files.begin(), changed_files.end());
+}
+
+vector<string> FileWatcher::poll_write_times() {
+	vector<string> changed_files;
+
+	Uint64 now = SDL_GetTicks64();
+	if (now - last_poll < POLL_INTERVAL)
+		return changed_files;
+	last_poll = now;
+
+	read_write_times(&changed_files);
+	return changed_files;
+}
+
+vector<string> FileWatcher::get_changed_files() {
+	if (inotify_fd >= 0)
+		return read_inotify_events();
+	return poll_write_times();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include "common.h"
+
+using namespace std;
+
+// watches a directory tree for written files, with inotify on Linux,
+// or by comparing the modification times of the files elsewhere
+class FileWatcher {
+	// the modification times are compared at most this often, in milliseconds
+	static const Uint64 POLL_INTERVAL = 500;
+
+	filesystem::path directory;
+
+	// inotify instance and the directory of each watch, -1 if inotify isn't used
+	int inotify_fd = -1;
+	unordered_map<int, filesystem::path> watched_directories;
+
+	unordered_map<string, filesystem::file_time_type> write_times;
+	Uint64 last_poll = 0;
+
+	void add_watches(const filesystem::path& watched_directory);
+	void read_write_times(vector<string>* changed_files);
+
+	vector<string> read_inotify_events();
+	vector<string> poll_write_times();
+
+public:
+	FileWatcher(const string& directory);
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// returns the paths of the files written since the last call, each once,
+	// the paths start with the watched directory
+	vector<string> get_changed_files();
+};
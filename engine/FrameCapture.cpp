@@ -0,0 +1,170 @@
+#include "../engine/FrameCapture.h"
+#include <filesystem>
+#include <algorithm>
+
+using namespace filesystem;
+
+// the byte order of this format is R, G, B, A on every platform
+static const Uint32 CAPTURE_FORMAT = SDL_PIXELFORMAT_RGBA32;
+
+FrameCapture::FrameCapture(const vector<uint>& frames, const string& directory, const string& raw_path) :
+	frames(frames.begin(), frames.end()), directory(directory)
+{
+	if (!raw_path.empty()) {
+		raw_stream = SDL_RWFromFile(raw_path.c_str(), "wb");
+		if (raw_stream == nullptr)
+			log_error("FrameCapture: Couldn't open '%s' for writing! Error: %s\n", raw_path.c_str(), SDL_GetError());
+		return;
+	}
+
+	error_code error;
+	create_directories(directory, error);
+	if (error)
+		log_error("FrameCapture: Couldn't create the directory '%s'! Error: %s\n", directory.c_str(), error.message().c_str());
+}
+
+FrameCapture::~FrameCapture() {
+	if (raw_stream)
+		SDL_RWclose(raw_stream);
+}
+
+bool FrameCapture::should_capture(const uint& frame) const { return frames.find(frame) != frames.end(); }
+
+void FrameCapture::capture(SDL_Renderer* renderer, const uint& frame) {
+	// the whole render target is read, that's the frame target or the window if there's none
+	int w = 0;
+	int h = 0;
+	SDL_Texture* target = SDL_GetRenderTarget(renderer);
+	if (target)
+		SDL_QueryTexture(target, nullptr, nullptr, &w, &h);
+	else
+		SDL_GetRendererOutputSize(renderer, &w, &h);
+
+	int pitch = w * 4;
+	pixels.resize(static_cast<size_t>(pitch) * h);
+	if (SDL_RenderReadPixels(renderer, nullptr, CAPTURE_FORMAT, pixels.data(), pitch) != 0) {
+		log_error("FrameCapture: Couldn't read the pixels of frame %u! Error: %s\n", frame, SDL_GetError());
+		return;
+	}
+
+	if (raw_stream) {
+		SDL_RWwrite(raw_stream, pixels.data(), pixels.size(), 1);
+		log_info("FrameCapture: Frame %u written to the raw stream (rgba, %dx%d).\n", frame, w, h);
+		return;
+	}
+
+	char file_name[32];
+	snprintf(file_name, sizeof(file_name), "frame_%06u.png", frame);
+	string file_path = (path(directory) / file_name).string();
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels.data(), w, h, 32, pitch, CAPTURE_FORMAT);
+	if (surface == nullptr || IMG_SavePNG(surface, file_path.c_str()) != 0)
+		log_error("FrameCapture: Couldn't save frame %u to '%s'! Error: %s\n", frame, file_path.c_str(), SDL_GetError());
+	else
+		log_info("FrameCapture: Frame %u saved to '%s'.\n", frame, file_path.c_str());
+
+	if (surface)
+		SDL_FreeSurface(surface);
+}
+
+// loads the image converted to the capture format, nullptr if it couldn't be loaded
+static SDL_Surface* load_compare_image(const string& image_path) {
+	SDL_Surface* loaded = IMG_Load(image_path.c_str());
+	if (loaded == nullptr) {
+		log_error("Couldn't load '%s'! Error: %s\n", image_path.c_str(), IMG_GetError());
+		return nullptr;
+	}
+
+	SDL_Surface* converted = SDL_ConvertSurfaceFormat(loaded, CAPTURE_FORMAT, 0);
+	SDL_FreeSurface(loaded);
+	return converted;
+}
+
+// compares two images and logs the result, returns true if they match within the tolerance
+static bool compare_images(const string& expected_path, const string& actual_path, const int& tolerance) {
+	SDL_Surface* expected = load_compare_image(expected_path);
+	SDL_Surface* actual = load_compare_image(actual_path);
+	bool matches = false;
+
+	if (expected && actual && (expected->w != actual->w || expected->h != actual->h)) {
+		log_error(
+			"  %s: size differs, expected %dx%d, got %dx%d\n",
+			actual_path.c_str(), expected->w, expected->h, actual->w, actual->h
+		);
+	}
+	else if (expected && actual) {
+		uint differing_pixels = 0;
+		int max_difference = 0;
+
+		for (int y = 0; y < expected->h; y++) {
+			const Uint8* expected_row = static_cast<const Uint8*>(expected->pixels) + y * expected->pitch;
+			const Uint8* actual_row = static_cast<const Uint8*>(actual->pixels) + y * actual->pitch;
+
+			for (int x = 0; x < expected->w; x++) {
+				int pixel_difference = 0;
+				for (int c = 0; c < 4; c++)
+					pixel_difference = max(pixel_difference, abs(expected_row[x * 4 + c] - actual_row[x * 4 + c]));
+
+				max_difference = max(max_difference, pixel_difference);
+				if (pixel_difference > tolerance)
+					differing_pixels++;
+			}
+		}
+
+		matches = differing_pixels == 0;
+		float differing_percent = 100.0F * differing_pixels / (expected->w * expected->h);
+		if (matches)
+			log_info("  %s: matches, max channel difference %d\n", actual_path.c_str(), max_difference);
+		else
+			log_error(
+				"  %s: %u pixels (%.3f%%) differ, max channel difference %d\n",
+				actual_path.c_str(), differing_pixels, differing_percent, max_difference
+			);
+	}
+
+	if (expected)
+		SDL_FreeSurface(expected);
+	if (actual)
+		SDL_FreeSurface(actual);
+
+	return matches;
+}
+
+int run_frame_compare(const string& expected_path, const string& actual_path, const int& tolerance) {
+	if (SDL_Init(0) < 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+		log_error("Couldn't initialize SDL_image! Error: %s\n", IMG_GetError());
+		return 1;
+	}
+
+	log_info("Comparing '%s' to '%s' with tolerance %d.\n", actual_path.c_str(), expected_path.c_str(), tolerance);
+
+	uint compared = 0;
+	uint mismatched = 0;
+
+	if (is_directory(expected_path)) {
+		// every expected frame must have a matching actual frame, extra actual frames are ignored
+		vector<path> expected_files;
+		for (const auto& entry : directory_iterator(expected_path))
+			if (entry.is_regular_file() && entry.path().extension() == ".png")
+				expected_files.push_back(entry.path());
+		sort(expected_files.begin(), expected_files.end());
+
+		for (const path& expected_file : expected_files) {
+			compared++;
+			if (!compare_images(expected_file.string(), (path(actual_path) / expected_file.filename()).string(), tolerance))
+				mismatched++;
+		}
+	}
+	else {
+		compared++;
+		if (!compare_images(expected_path, actual_path, tolerance))
+			mismatched++;
+	}
+
+	log_info("%u of %u images match.\n", compared - mismatched, compared);
+
+	IMG_Quit();
+	SDL_Quit();
+
+	return mismatched == 0 && compared > 0 ? 0 : 1;
+}
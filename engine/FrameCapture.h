@@ -0,0 +1,34 @@
+#pragma once
+#include <SDL.h>
+#include <SDL_image.h>
+#include <string>
+#include <vector>
+#include <set>
+#include "common.h"
+
+using namespace std;
+
+// captures rendered frames at the chosen frame numbers, either as a PNG sequence
+// in a directory or as a raw RGBA stream appended to one file
+class FrameCapture {
+	set<uint> frames;
+	string directory;
+	SDL_RWops* raw_stream = nullptr;
+	vector<Uint8> pixels;
+
+public:
+	// the raw stream is used if raw_path isn't empty, otherwise PNGs are written to directory
+	FrameCapture(const vector<uint>& frames, const string& directory, const string& raw_path);
+	~FrameCapture();
+
+	bool should_capture(const uint& frame) const;
+
+	// reads the pixels of the current render target and writes them out,
+	// must be called after drawing and before the frame is presented
+	void capture(SDL_Renderer* renderer, const uint& frame);
+};
+
+// compares two PNG images or two directories of PNG images with the same file names,
+// a pixel differs if any of it's channels differ by more than the tolerance,
+// the results are logged and the return value is 0 if nothing differs, 1 otherwise
+int run_frame_compare(const string& expected_path, const string& actual_path, const int& tolerance);
@@ -0,0 +1,192 @@
+#include "../engine/Kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// GCC and Clang need the instruction set enabled per function to compile it's intrinsics,
+// MSVC allows intrinsics of any instruction set without that
+#if defined(__GNUC__) || defined(__clang__)
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define KERNEL_TARGET(isa)
+#endif
+
+// scalar kernels, also used for the remainders of vectorized kernels
+
+static void integrate_particles_scalar(
+	float* position_x, float* position_y,
+	float* velocity_x, float* velocity_y,
+	uint count, float delta, float gravity
+) {
+	for (uint i = 0; i < count; i++) {
+		position_x[i] += velocity_x[i] * delta;
+		position_y[i] += velocity_y[i] * delta;
+		velocity_y[i] += gravity * delta;
+	}
+}
+
+static void ball_transforms_scalar(
+	const TrackArrays& track,
+	const float* track_positions, const uint* segment_indices, uint count,
+	float* out_x, float* out_y, float* out_rotation
+) {
+	for (uint i = 0; i < count; i++) {
+		uint s = segment_indices[i];
+		// ball's position relative to the start of the track segment it's in
+		float segment_position = track_positions[i] - track.start_length[s];
+
+		out_x[i] = track.start_x[s] + track.angle_cos[s] * segment_position;
+		out_y[i] = track.start_y[s] + track.angle_sin[s] * segment_position;
+		// balls point (or roll) in the direction of the track segment
+		out_rotation[i] = track.angle[s] + 90;
+	}
+}
+
+#ifdef KERNELS_X86
+
+// SSE2 kernels, 4 elements per iteration
+
+KERNEL_TARGET("sse2")
+static void integrate_particles_sse2(
+	float* position_x, float* position_y,
+	float* velocity_x, float* velocity_y,
+	uint count, float delta, float gravity
+) {
+	__m128 delta_v = _mm_set1_ps(delta);
+	__m128 gravity_step = _mm_set1_ps(gravity * delta);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 vx = _mm_loadu_ps(velocity_x + i);
+		__m128 vy = _mm_loadu_ps(velocity_y + i);
+
+		_mm_storeu_ps(position_x + i, _mm_add_ps(_mm_loadu_ps(position_x + i), _mm_mul_ps(vx, delta_v)));
+		_mm_storeu_ps(position_y + i, _mm_add_ps(_mm_loadu_ps(position_y + i), _mm_mul_ps(vy, delta_v)));
+		_mm_storeu_ps(velocity_y + i, _mm_add_ps(vy, gravity_step));
+	}
+
+	integrate_particles_scalar(position_x + i, position_y + i, velocity_x + i, velocity_y + i, count - i, delta, gravity);
+}
+
+KERNEL_TARGET("sse2")
+static void ball_transforms_sse2(
+	const TrackArrays& track,
+	const float* track_positions, const uint* segment_indices, uint count,
+	float* out_x, float* out_y, float* out_rotation
+) {
+	const float* start_x = track.start_x.data();
+	const float* start_y = track.start_y.data();
+	const float* start_length = track.start_length.data();
+	const float* angle_cos = track.angle_cos.data();
+	const float* angle_sin = track.angle_sin.data();
+	const float* angle = track.angle.data();
+
+	__m128 quarter_turn = _mm_set1_ps(90.0F);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		// SSE2 has no gather, so the segment values are loaded lane by lane
+		const uint* s = segment_indices + i;
+		__m128 seg_start_x = _mm_setr_ps(start_x[s[0]], start_x[s[1]], start_x[s[2]], start_x[s[3]]);
+		__m128 seg_start_y = _mm_setr_ps(start_y[s[0]], start_y[s[1]], start_y[s[2]], start_y[s[3]]);
+		__m128 seg_start_length = _mm_setr_ps(start_length[s[0]], start_length[s[1]], start_length[s[2]], start_length[s[3]]);
+		__m128 seg_cos = _mm_setr_ps(angle_cos[s[0]], angle_cos[s[1]], angle_cos[s[2]], angle_cos[s[3]]);
+		__m128 seg_sin = _mm_setr_ps(angle_sin[s[0]], angle_sin[s[1]], angle_sin[s[2]], angle_sin[s[3]]);
+		__m128 seg_angle = _mm_setr_ps(angle[s[0]], angle[s[1]], angle[s[2]], angle[s[3]]);
+
+		__m128 segment_position = _mm_sub_ps(_mm_loadu_ps(track_positions + i), seg_start_length);
+
+		_mm_storeu_ps(out_x + i, _mm_add_ps(seg_start_x, _mm_mul_ps(seg_cos, segment_position)));
+		_mm_storeu_ps(out_y + i, _mm_add_ps(seg_start_y, _mm_mul_ps(seg_sin, segment_position)));
+		_mm_storeu_ps(out_rotation + i, _mm_add_ps(seg_angle, quarter_turn));
+	}
+
+	ball_transforms_scalar(track, track_positions + i, segment_indices + i, count - i, out_x + i, out_y + i, out_rotation + i);
+}
+
+// AVX2 kernels, 8 elements per iteration
+
+KERNEL_TARGET("avx2")
+static void integrate_particles_avx2(
+	float* position_x, float* position_y,
+	float* velocity_x, float* velocity_y,
+	uint count, float delta, float gravity
+) {
+	__m256 delta_v = _mm256_set1_ps(delta);
+	__m256 gravity_step = _mm256_set1_ps(gravity * delta);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 vx = _mm256_loadu_ps(velocity_x + i);
+		__m256 vy = _mm256_loadu_ps(velocity_y + i);
+
+		_mm256_storeu_ps(position_x + i, _mm256_add_ps(_mm256_loadu_ps(position_x + i), _mm256_mul_ps(vx, delta_v)));
+		_mm256_storeu_ps(position_y + i, _mm256_add_ps(_mm256_loadu_ps(position_y + i), _mm256_mul_ps(vy, delta_v)));
+		_mm256_storeu_ps(velocity_y + i, _mm256_add_ps(vy, gravity_step));
+	}
+
+	integrate_particles_scalar(position_x + i, position_y + i, velocity_x + i, velocity_y + i, count - i, delta, gravity);
+}
+
+KERNEL_TARGET("avx2")
+static void ball_transforms_avx2(
+	const TrackArrays& track,
+	const float* track_positions, const uint* segment_indices, uint count,
+	float* out_x, float* out_y, float* out_rotation
+) {
+	__m256 quarter_turn = _mm256_set1_ps(90.0F);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(segment_indices + i));
+
+		__m256 seg_start_x = _mm256_i32gather_ps(track.start_x.data(), s, 4);
+		__m256 seg_start_y = _mm256_i32gather_ps(track.start_y.data(), s, 4);
+		__m256 seg_start_length = _mm256_i32gather_ps(track.start_length.data(), s, 4);
+		__m256 seg_cos = _mm256_i32gather_ps(track.angle_cos.data(), s, 4);
+		__m256 seg_sin = _mm256_i32gather_ps(track.angle_sin.data(), s, 4);
+		__m256 seg_angle = _mm256_i32gather_ps(track.angle.data(), s, 4);
+
+		__m256 segment_position = _mm256_sub_ps(_mm256_loadu_ps(track_positions + i), seg_start_length);
+
+		_mm256_storeu_ps(out_x + i, _mm256_add_ps(seg_start_x, _mm256_mul_ps(seg_cos, segment_position)));
+		_mm256_storeu_ps(out_y + i, _mm256_add_ps(seg_start_y, _mm256_mul_ps(seg_sin, segment_position)));
+		_mm256_storeu_ps(out_rotation + i, _mm256_add_ps(seg_angle, quarter_turn));
+	}
+
+	ball_transforms_scalar(track, track_positions + i, segment_indices + i, count - i, out_x + i, out_y + i, out_rotation + i);
+}
+
+#endif
+
+static const Kernels SCALAR_KERNELS = { "scalar", integrate_particles_scalar, ball_transforms_scalar };
+#ifdef KERNELS_X86
+static const Kernels SSE2_KERNELS = { "sse2", integrate_particles_sse2, ball_transforms_sse2 };
+static const Kernels AVX2_KERNELS = { "avx2", integrate_particles_avx2, ball_transforms_avx2 };
+#endif
+
+vector<const Kernels*> Kernels::get_supported() {
+	vector<const Kernels*> result = { &SCALAR_KERNELS };
+
+#ifdef KERNELS_X86
+	if (SDL_HasSSE2())
+		result.push_back(&SSE2_KERNELS);
+	if (SDL_HasAVX2())
+		result.push_back(&AVX2_KERNELS);
+#endif
+
+	return result;
+}
+
+const Kernels& Kernels::get() {
+	// the supported kernels are ordered from the slowest to the fastest
+	static const Kernels* selected = []() {
+		const Kernels* kernels = get_supported().back();
+		log_info("Kernels: Using %s kernels.\n", kernels->name);
+		return kernels;
+	}();
+
+	return *selected;
+}
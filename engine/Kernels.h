@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include "common.h"
+
+using namespace std;
+
+// track segment values laid out as separate arrays for the batched kernels
+struct TrackArrays {
+	vector<float> start_x;			// X of the segment's start point
+	vector<float> start_y;			// Y of the segment's start point
+	vector<float> start_length;		// track length before the segment
+	vector<float> angle_cos;
+	vector<float> angle_sin;
+	vector<float> angle;			// segment angle in degrees
+};
+
+// integrates particle positions by their velocities and velocities by gravity
+typedef void (*IntegrateParticlesKernel)(
+	float* position_x, float* position_y,
+	float* velocity_x, float* velocity_y,
+	uint count, float delta, float gravity
+);
+
+// computes world positions and rotations of balls from their positions along the track
+// and indices of the track segments they are in
+typedef void (*BallTransformsKernel)(
+	const TrackArrays& track,
+	const float* track_positions, const uint* segment_indices, uint count,
+	float* out_x, float* out_y, float* out_rotation
+);
+
+// a set of kernels built for one instruction set
+struct Kernels {
+	const char* name;
+	IntegrateParticlesKernel integrate_particles;
+	BallTransformsKernel ball_transforms;
+
+	// the fastest kernel set supported by the current CPU, selected on the first call
+	static const Kernels& get();
+
+	// all kernel sets supported by the current CPU, the first one is always the scalar one
+	static vector<const Kernels*> get_supported();
+};
@@ -0,0 +1,154 @@
+#include "../engine/LZ4.h"
+#include <cstring>
+
+namespace LZ4 {
+	static const size_t MIN_MATCH = 4;
+	// the last match must start this many bytes before the end of the block
+	static const size_t MATCH_START_LIMIT = 12;
+	// the last bytes of the block are always literals
+	static const size_t LAST_LITERALS = 5;
+	static const size_t MAX_OFFSET = 0xFFFF;
+	static const uint HASH_BITS = 16;
+
+	static Uint32 read32(const Uint8* data) {
+		Uint32 value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	static uint hash(const Uint32& sequence) {
+		return (sequence * 2654435761U) >> (32 - HASH_BITS);
+	}
+
+	// writes the part of a length that doesn't fit into the token's 4 bits
+	static void write_length(vector<Uint8>& out, size_t length) {
+		while (length >= 0xFF) {
+			out.push_back(0xFF);
+			length -= 0xFF;
+		}
+		out.push_back(static_cast<Uint8>(length));
+	}
+
+	static void write_sequence(vector<Uint8>& out, const Uint8* literals, const size_t& literal_length, const size_t& offset, const size_t& match_length) {
+		size_t match_code = match_length >= MIN_MATCH ? match_length - MIN_MATCH : 0;
+
+		Uint8 token = static_cast<Uint8>((literal_length >= 15 ? 15 : literal_length) << 4);
+		if (match_length > 0)
+			token |= static_cast<Uint8>(match_code >= 15 ? 15 : match_code);
+		out.push_back(token);
+
+		if (literal_length >= 15)
+			write_length(out, literal_length - 15);
+		if (literal_length > 0)
+			out.insert(out.end(), literals, literals + literal_length);
+
+		// the last sequence has only literals
+		if (match_length == 0)
+			return;
+
+		out.push_back(static_cast<Uint8>(offset & 0xFF));
+		out.push_back(static_cast<Uint8>(offset >> 8));
+		if (match_code >= 15)
+			write_length(out, match_code - 15);
+	}
+
+	vector<Uint8> compress(const Uint8* data, const size_t& size) {
+		vector<Uint8> out;
+		out.reserve(size / 2 + 16);
+
+		// positions of the last occurence of every hashed 4 byte sequence, plus one, as 0 means none
+		vector<Uint32> table(static_cast<size_t>(1) << HASH_BITS, 0);
+
+		size_t position = 0;
+		size_t anchor = 0;
+
+		if (size > MATCH_START_LIMIT) {
+			size_t match_start_end = size - MATCH_START_LIMIT;
+			size_t match_end_limit = size - LAST_LITERALS;
+
+			while (position < match_start_end) {
+				Uint32 sequence = read32(data + position);
+				uint h = hash(sequence);
+				size_t candidate = table[h];
+				table[h] = static_cast<Uint32>(position + 1);
+
+				if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET || read32(data + candidate - 1) != sequence) {
+					position++;
+					continue;
+				}
+				candidate--;
+
+				size_t match_length = MIN_MATCH;
+				while (position + match_length < match_end_limit && data[candidate + match_length] == data[position + match_length])
+					match_length++;
+
+				write_sequence(out, data + anchor, position - anchor, position - candidate, match_length);
+				position += match_length;
+				anchor = position;
+			}
+		}
+
+		write_sequence(out, data + anchor, size - anchor, 0, 0);
+		return out;
+	}
+
+	// reads the part of a length that didn't fit into the token's 4 bits
+	static bool read_length(const Uint8*& in, const Uint8* in_end, size_t& length) {
+		Uint8 byte;
+		do {
+			if (in >= in_end)
+				return false;
+			byte = *in++;
+			length += byte;
+		} while (byte == 0xFF);
+
+		return true;
+	}
+
+	bool decompress(const Uint8* block, const size_t& block_size, Uint8* output, const size_t& output_size) {
+		const Uint8* in = block;
+		const Uint8* in_end = block + block_size;
+		Uint8* out = output;
+		Uint8* out_end = output + output_size;
+
+		while (in < in_end) {
+			Uint8 token = *in++;
+
+			size_t literal_length = token >> 4;
+			if (literal_length == 15 && !read_length(in, in_end, literal_length))
+				return false;
+
+			if (literal_length > static_cast<size_t>(in_end - in) || literal_length > static_cast<size_t>(out_end - out))
+				return false;
+			if (literal_length > 0)
+				memcpy(out, in, literal_length);
+			in += literal_length;
+			out += literal_length;
+
+			// the last sequence ends after it's literals
+			if (in == in_end)
+				break;
+
+			if (in_end - in < 2)
+				return false;
+			size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+			in += 2;
+
+			size_t match_length = token & 0x0F;
+			if (match_length == 15 && !read_length(in, in_end, match_length))
+				return false;
+			match_length += MIN_MATCH;
+
+			if (offset == 0 || offset > static_cast<size_t>(out - output) || match_length > static_cast<size_t>(out_end - out))
+				return false;
+
+			// matches may overlap their own output, so they are copied byte by byte
+			const Uint8* match = out - offset;
+			for (size_t i = 0; i < match_length; i++)
+				out[i] = match[i];
+			out += match_length;
+		}
+
+		return out == out_end;
+	}
+}
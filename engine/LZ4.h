@@ -0,0 +1,17 @@
+#pragma once
+#include <SDL.h>
+#include <vector>
+#include "common.h"
+
+using namespace std;
+
+// LZ4 block format compression, without the frame format around the blocks.
+// the decompressed size isn't stored in a block, so it has to be kept alongside it
+namespace LZ4 {
+	// compresses the data into a single block, a greedy compressor that favors speed over ratio
+	vector<Uint8> compress(const Uint8* data, const size_t& size);
+
+	// decompresses the block into exactly output_size bytes,
+	// returns false if the block is malformed or doesn't decompress to that size
+	bool decompress(const Uint8* block, const size_t& block_size, Uint8* output, const size_t& output_size);
+}
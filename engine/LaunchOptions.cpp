@@ -0,0 +1,163 @@
+#include "../engine/LaunchOptions.h"
+#include "../engine/common.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+// if the argument has the "--name=value" form, writes the value and returns true
+static bool get_argument_value(const string& arg, const string& name, string& value) {
+	string arg_prefix = name + "=";
+	if (arg.rfind(arg_prefix, 0) != 0)
+		return false;
+
+	value = arg.substr(arg_prefix.size());
+	return true;
+}
+
+// ranges longer than this are skipped, as every frame of a range is listed
+static const uint MAX_FRAME_RANGE = 100000;
+
+// parses a whole non-negative frame number, returns false if it isn't one
+static bool parse_frame_number(const string& text, uint& frame) {
+	// strtoul would accept a sign and wrap negative numbers around
+	if (text.empty() || !isdigit(static_cast<unsigned char>(text[0])))
+		return false;
+
+	errno = 0;
+	char* end = nullptr;
+	unsigned long value = strtoul(text.c_str(), &end, 10);
+	if (errno == ERANGE || *end != '\0' || value > UINT_MAX)
+		return false;
+
+	frame = static_cast<uint>(value);
+	return true;
+}
+
+// parses a list of frame numbers and ranges like "1,10,100-200",
+// invalid numbers and ranges are logged and skipped
+static vector<uint> parse_frame_list(const string& list) {
+	vector<uint> frames;
+
+	size_t start = 0;
+	while (start < list.size()) {
+		size_t end = list.find(',', start);
+		if (end == string::npos)
+			end = list.size();
+
+		string item = list.substr(start, end - start);
+		start = end + 1;
+
+		size_t dash = item.find('-');
+		if (dash == string::npos) {
+			uint frame = 0;
+			if (parse_frame_number(item, frame))
+				frames.push_back(frame);
+			else
+				log_warn("LaunchOptions: Invalid frame number '%s', skipping.\n", item.c_str());
+			continue;
+		}
+
+		uint first = 0;
+		uint last = 0;
+		if (!parse_frame_number(item.substr(0, dash), first) || !parse_frame_number(item.substr(dash + 1), last) || first > last) {
+			log_warn("LaunchOptions: Invalid frame range '%s', skipping.\n", item.c_str());
+			continue;
+		}
+		if (last - first >= MAX_FRAME_RANGE) {
+			log_warn("LaunchOptions: Frame range '%s' has more than %u frames, skipping.\n", item.c_str(), MAX_FRAME_RANGE);
+			continue;
+		}
+
+		// counted from the start, so a range ending at the largest number still ends
+		for (uint i = 0; i <= last - first; i++)
+			frames.push_back(first + i);
+	}
+
+	return frames;
+}
+
+LaunchOptions LaunchOptions::parse(int argc, char** argv) {
+	LaunchOptions options;
+
+	// the first argument is the executable path, skip it
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		string value;
+
+		if (arg == "--tinted-balls")
+			options.tinted_balls = true;
+		else if (arg == "--integer-scale")
+			options.integer_scaling = true;
+		else if (get_argument_value(arg, "--supersample", value))
+			options.supersampling = clamp(atoi(value.c_str()), 1, 4);
+		else if (get_argument_value(arg, "--renderer", value))
+			options.render_driver = value;
+		else if (get_argument_value(arg, "--pack", value))
+			options.pack_path = value;
+		else if (get_argument_value(arg, "--background-budget", value))
+			options.background_budget = static_cast<uint>(max(atoi(value.c_str()), 0));
+		else if (get_argument_value(arg, "--build-pack", value))
+			options.build_pack_path = value;
+		else if (get_argument_value(arg, "--convert-catex", value)) {
+			// "--convert-catex=input,output"
+			size_t comma = value.find(',');
+			options.convert_input = value.substr(0, comma);
+			options.convert_output = comma != string::npos ? value.substr(comma + 1) : options.convert_input;
+		}
+		else if (get_argument_value(arg, "--compile-levels", value)) {
+			// "--compile-levels=input,output"
+			size_t comma = value.find(',');
+			options.compile_input = value.substr(0, comma);
+			options.compile_output = comma != string::npos ? value.substr(comma + 1) : options.compile_input;
+		}
+		else if (get_argument_value(arg, "--raw-format", value)) {
+			if (value == "rgba")
+				options.convert_format = RPFRGBA;
+			else if (value == "bgra")
+				options.convert_format = RPFBGRA;
+			else
+				log_warn("LaunchOptions: Unknown raw format '%s', expected rgba or bgra.\n", value.c_str());
+		}
+		else if (arg == "--straight-alpha")
+			options.convert_premultiply = false;
+		else if (arg == "--no-compression")
+			options.convert_compress = false;
+		else if (arg == "--hot-reload")
+			options.hot_reload = true;
+		else if (arg == "--headless")
+			options.headless = true;
+		else if (get_argument_value(arg, "--level", value))
+			options.level = value;
+		else if (get_argument_value(arg, "--frames", value))
+			options.frame_limit = static_cast<uint>(max(atoi(value.c_str()), 0));
+		else if (get_argument_value(arg, "--capture-frames", value))
+			options.capture_frames = parse_frame_list(value);
+		else if (get_argument_value(arg, "--capture-dir", value))
+			options.capture_directory = value;
+		else if (get_argument_value(arg, "--capture-raw", value))
+			options.capture_raw_path = value;
+		else if (get_argument_value(arg, "--compare", value)) {
+			// "--compare=expected,actual"
+			size_t comma = value.find(',');
+			options.compare_expected = value.substr(0, comma);
+			if (comma != string::npos)
+				options.compare_actual = value.substr(comma + 1);
+		}
+		else if (get_argument_value(arg, "--tolerance", value))
+			options.compare_tolerance = clamp(atoi(value.c_str()), 0, 255);
+		else if (arg == "--bench-kernels")
+			options.bench_kernels = true;
+		else if (arg == "--bench-render")
+			options.bench_render = true;
+		else
+			log_warn("LaunchOptions: Unknown argument '%s', skipping.\n", arg.c_str());
+	}
+
+	// stop right after the last captured frame if no frame limit is given
+	if (options.frame_limit == 0 && !options.capture_frames.empty())
+		options.frame_limit = *max_element(options.capture_frames.begin(), options.capture_frames.end());
+
+	return options;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "common.h"
+#include "RawTexture.h"
+
+using namespace std;
+
+// options given to the game through the command line
+struct LaunchOptions {
+	static constexpr const char* DEFAULT_PACK_PATH = "assets.capak";
+
+	// draw every ball color from one neutral spritesheet tinted at runtime
+	// instead of loading a separate spritesheet per color
+	bool tinted_balls = false;
+
+	// scale the frame only by whole numbers
+	bool integer_scaling = false;
+	// draw the frame at this multiple of the logical resolution
+	int supersampling = 1;
+	// SDL render driver to use instead of the one from the settings (opengl, opengles2, software...)
+	string render_driver;
+
+	// asset pack to load assets from, assets missing from it are loaded from files,
+	// the default pack is used only if it exists
+	string pack_path = DEFAULT_PACK_PATH;
+	// size of the level backgrounds kept loaded after their levels are left, in MiB
+	uint background_budget = 64;
+	// pack the assets directory into this pack instead of running the game
+	string build_pack_path;
+
+	// convert PNG .catex textures to raw textures instead of running the game,
+	// the input and output are both files or both directories
+	string convert_input;
+	string convert_output;
+	// pixel byte order of the converted textures
+	RawPixelFormat convert_format = RPFBGRA;
+	// premultiply the converted colors by the alpha
+	bool convert_premultiply = true;
+	// compress the converted pixels with LZ4
+	bool convert_compress = true;
+
+	// compile a level XML file, or every level XML file in a directory, to compiled levels (.calev)
+	// instead of running the game, the output is next to the input if it isn't given
+	string compile_input;
+	string compile_output;
+
+	// watch the assets directory and reload changed textures, UI textures and levels in place
+	bool hot_reload = false;
+
+	// hidden window, fixed frame delta and no frame limiting, for deterministic automated runs
+	bool headless = false;
+	// level to start in instead of the menu
+	string level;
+	// exit after this many frames, 0 runs until the game is exited
+	uint frame_limit = 0;
+
+	// frame numbers to capture, given as a list of numbers and ranges: "1,10,100-200"
+	vector<uint> capture_frames;
+	// directory for the captured PNG sequence
+	string capture_directory = "captures";
+	// file for a raw RGBA stream of the captured frames, used instead of the PNG sequence if set
+	string capture_raw_path;
+
+	// compare the expected images or directories to the actual ones instead of running the game
+	string compare_expected;
+	string compare_actual;
+	// maximum channel difference of matching pixels
+	int compare_tolerance = 0;
+
+	// run the kernel benchmark instead of the game
+	bool bench_kernels = false;
+	// run the render benchmark on every available render driver instead of the game
+	bool bench_render = false;
+
+	// parses the command line arguments, unknown arguments are logged and skipped
+	static LaunchOptions parse(int argc, char** argv);
+};
@@ -0,0 +1,98 @@
+#include "../engine/ParticlePool.h"
+#include "../engine/Kernels.h"
+
+ParticlePool::ParticlePool(Texture* particle_texture) : texture(particle_texture) {
+	vertices.reserve(CAPACITY * 4);
+
+	// every particle is a quad made of two triangles: (0, 1, 2) and (2, 3, 0)
+	indices.reserve(CAPACITY * 6);
+	for (int i = 0; i < static_cast<int>(CAPACITY); i++) {
+		int first_vertex = i * 4;
+		indices.insert(indices.end(), {
+			first_vertex, first_vertex + 1, first_vertex + 2,
+			first_vertex + 2, first_vertex + 3, first_vertex
+		});
+	}
+}
+
+bool ParticlePool::emit(const vec2& position, const vec2& velocity, const SDL_Color& color) {
+	if (count >= CAPACITY)
+		return false;
+
+	position_x[count] = position.x;
+	position_y[count] = position.y;
+	velocity_x[count] = velocity.x;
+	velocity_y[count] = velocity.y;
+	colors[count] = color;
+	count++;
+
+	return true;
+}
+
+void ParticlePool::remove(const uint& index) {
+	count--;
+
+	// the particle order doesn't matter, so instead of shifting
+	// every particle after the removed one, the last particle takes it's place
+	position_x[index] = position_x[count];
+	position_y[index] = position_y[count];
+	velocity_x[index] = velocity_x[count];
+	velocity_y[index] = velocity_y[count];
+	colors[index] = colors[count];
+}
+
+void ParticlePool::clear() { count = 0; }
+
+const uint& ParticlePool::get_count() const { return count; }
+
+void ParticlePool::update(const float& delta, GameState&) {
+	Kernels::get().integrate_particles(
+		position_x.data(), position_y.data(),
+		velocity_x.data(), velocity_y.data(),
+		count, delta, GRAVITY
+	);
+
+	// particles that left the screen through the sides or the bottom are removed,
+	// the swapped-in particle is checked on the next iteration with the same index
+	uint i = 0;
+	while (i < count) {
+		if (position_x[i] > WINDOW_WIDTH + SIZE || position_x[i] < -SIZE || position_y[i] > WINDOW_HEIGHT + SIZE)
+			remove(i);
+		else
+			i++;
+	}
+}
+
+bool ParticlePool::is_visible() const { return count > 0 && texture != nullptr; }
+
+void ParticlePool::draw(SDL_Renderer* renderer, const RendererState& renderer_state) const {
+	if (count == 0 || texture == nullptr)
+		return;
+
+	vertices.clear();
+	for (uint i = 0; i < count; i++) {
+		float x = position_x[i] - SIZE / 2;
+		float y = position_y[i] - SIZE / 2;
+		const SDL_Color& color = colors[i];
+
+		// particles flying above the screen aren't removed, as gravity brings them back,
+		// but they aren't submitted until then. the pool is counted as a whole by cull_drawable
+		if (y + SIZE < 0 || y > WINDOW_HEIGHT || x + SIZE < 0 || x > WINDOW_WIDTH)
+			continue;
+
+		// vertex color multiplies the texture color, same as SDL_SetTextureColorMod
+		vertices.push_back({ { x, y }, color, { 0, 0 } });
+		vertices.push_back({ { x + SIZE, y }, color, { 1, 0 } });
+		vertices.push_back({ { x + SIZE, y + SIZE }, color, { 1, 1 } });
+		vertices.push_back({ { x, y + SIZE }, color, { 0, 1 } });
+	}
+
+	if (vertices.empty())
+		return;
+
+	SDL_RenderGeometry(
+		renderer, texture->get_raw(),
+		vertices.data(), static_cast<int>(vertices.size()),
+		indices.data(), static_cast<int>(vertices.size() / 4 * 6)
+	);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <SDL.h>
+#include <array>
+#include <vector>
+#include "basics.h"
+#include "Texture.h"
+
+using namespace std;
+
+// ParticlePool is a single fixed-capacity store for all particles of a scene.
+//
+// particle fields are kept in separate arrays (structure of arrays), dead particles
+// are swap-removed with the last one, and all particles are drawn in one batched call
+class ParticlePool : public Drawable, public Updatable {
+public:
+	static const uint CAPACITY = 2048;
+	static constexpr float GRAVITY = 100.0F;
+	static constexpr float SIZE = 10.0F;
+
+private:
+	uint count = 0;
+
+	array<float, CAPACITY> position_x;
+	array<float, CAPACITY> position_y;
+	array<float, CAPACITY> velocity_x;
+	array<float, CAPACITY> velocity_y;
+	array<SDL_Color, CAPACITY> colors;
+
+	Texture* texture;
+
+	// vertex buffer is rebuilt on every draw, but it's memory is reused between frames
+	mutable vector<SDL_Vertex> vertices;
+	// index buffer is the same for every frame, so it's filled once for the whole capacity
+	vector<int> indices;
+
+	// removes the particle by moving the last particle in it's place
+	void remove(const uint& index);
+
+public:
+	ParticlePool(Texture* particle_texture);
+
+	// adds a new particle to the pool, returns false if the pool is full
+	bool emit(const vec2& position, const vec2& velocity, const SDL_Color& color);
+	// removes all particles
+	void clear();
+
+	const uint& get_count() const;
+
+	void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const override;
+	bool is_visible() const override;
+	void update(const float& delta, GameState& game_state) override;
+};
@@ -0,0 +1,266 @@
+#include "../engine/RawTexture.h"
+#include "../engine/AssetManager.h"
+#include "../engine/LZ4.h"
+#include <vector>
+#include <cstring>
+#include <climits>
+#include <filesystem>
+
+using namespace filesystem;
+
+void RawTextureHeader::read(const unsigned char* bytes) {
+	format = static_cast<RawPixelFormat>(bytes[0]);
+	flags = bytes[1];
+	width = static_cast<ushort>(bytes[2] << 8 | bytes[3]);
+	height = static_cast<ushort>(bytes[4] << 8 | bytes[5]);
+	data_size = static_cast<uint>(bytes[6]) << 24 | static_cast<uint>(bytes[7]) << 16 | static_cast<uint>(bytes[8]) << 8 | bytes[9];
+}
+
+void RawTextureHeader::write(unsigned char* bytes) const {
+	bytes[0] = static_cast<unsigned char>(format);
+	bytes[1] = flags;
+	bytes[2] = static_cast<unsigned char>(width >> 8);
+	bytes[3] = static_cast<unsigned char>(width);
+	bytes[4] = static_cast<unsigned char>(height >> 8);
+	bytes[5] = static_cast<unsigned char>(height);
+	bytes[6] = static_cast<unsigned char>(data_size >> 24);
+	bytes[7] = static_cast<unsigned char>(data_size >> 16);
+	bytes[8] = static_cast<unsigned char>(data_size >> 8);
+	bytes[9] = static_cast<unsigned char>(data_size);
+}
+
+// the byte order formats, they are the same on every platform
+Uint32 RawTextureHeader::get_sdl_format() const { return format == RPFRGBA ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_BGRA32; }
+
+bool RawTextureHeader::is_premultiplied() const { return flags & FLAG_PREMULTIPLIED; }
+
+bool RawTextureHeader::is_compressed() const { return flags & FLAG_LZ4; }
+
+SDL_Surface* RawTexture::decode(SDL_RWops* io, RawTextureHeader& header) {
+	unsigned char header_bytes[RawTextureHeader::SIZE];
+	if (SDL_RWread(io, header_bytes, sizeof(header_bytes), 1) != 1) {
+		SDL_SetError("couldn't read the raw texture header");
+		return nullptr;
+	}
+	header.read(header_bytes);
+
+	if (header.format != RPFRGBA && header.format != RPFBGRA) {
+		SDL_SetError("unknown raw texture pixel format %d", static_cast<int>(header.format));
+		return nullptr;
+	}
+
+	// the stored pixels are tightly packed, uncompressed ones are exactly this size and compressed ones aren't bigger
+	size_t pixels_size = static_cast<size_t>(header.width) * header.height * 4;
+	bool is_size_valid = header.is_compressed() ? header.data_size <= pixels_size : header.data_size == pixels_size;
+
+	// the data size is checked against the rest of the stream before it's allocated,
+	// streams of unknown size are only checked when read
+	Sint64 stream_size = SDL_RWsize(io);
+	Sint64 stream_position = SDL_RWtell(io);
+	if (stream_size >= 0 && stream_position >= 0 && header.data_size > static_cast<Uint64>(stream_size - stream_position))
+		is_size_valid = false;
+
+	if (!is_size_valid) {
+		SDL_SetError("raw texture pixel data size %u doesn't match the texture", header.data_size);
+		return nullptr;
+	}
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, header.width, header.height, 32, header.get_sdl_format());
+	if (surface == nullptr)
+		return nullptr;
+
+	// surfaces may pad their rows
+	bool is_packed = surface->pitch == header.width * 4;
+
+	vector<Uint8> data(header.data_size);
+	bool is_read = data.empty() || SDL_RWread(io, data.data(), data.size(), 1) == 1;
+
+	vector<Uint8> unpacked;
+	Uint8* pixels = is_packed ? static_cast<Uint8*>(surface->pixels) : nullptr;
+	if (!is_packed) {
+		unpacked.resize(pixels_size);
+		pixels = unpacked.data();
+	}
+
+	bool is_decoded = false;
+	if (is_read && header.is_compressed())
+		is_decoded = LZ4::decompress(data.data(), data.size(), pixels, pixels_size);
+	else if (is_read && data.size() == pixels_size) {
+		memcpy(pixels, data.data(), pixels_size);
+		is_decoded = true;
+	}
+
+	if (!is_decoded) {
+		SDL_FreeSurface(surface);
+		SDL_SetError("raw texture pixel data is truncated or corrupted");
+		return nullptr;
+	}
+
+	if (!is_packed)
+		for (int y = 0; y < header.height; y++)
+			memcpy(static_cast<Uint8*>(surface->pixels) + y * surface->pitch, pixels + y * header.width * 4, header.width * 4);
+
+	return surface;
+}
+
+void RawTexture::unpremultiply(SDL_Surface* surface) {
+	for (int y = 0; y < surface->h; y++) {
+		Uint8* row = static_cast<Uint8*>(surface->pixels) + y * surface->pitch;
+		for (int x = 0; x < surface->w; x++) {
+			// alpha is the last byte in both formats
+			Uint8* pixel = row + x * 4;
+			Uint8 alpha = pixel[3];
+			if (alpha == 0 || alpha == 255)
+				continue;
+
+			for (int c = 0; c < 3; c++)
+				pixel[c] = static_cast<Uint8>(min(pixel[c] * 255 / alpha, 255));
+		}
+	}
+}
+
+// converts a single .catex file, returns false on errors
+static bool convert_file(const string& input_path, const string& output_path, const RawPixelFormat& format, const bool& premultiply, const bool& compress) {
+	SDL_RWops* input = SDL_RWFromFile(input_path.c_str(), "rb");
+	unsigned char signature[6];
+	if (input == nullptr || SDL_RWread(input, signature, sizeof(signature), 1) != 1) {
+		log_error("  %s: couldn't be read! Error: %s\n", input_path.c_str(), SDL_GetError());
+		if (input)
+			SDL_RWclose(input);
+		return false;
+	}
+
+	if (signature[5] == ATRawTexture) {
+		log_info("  %s: already a raw texture, skipping\n", input_path.c_str());
+		SDL_RWclose(input);
+		return true;
+	}
+
+	if (signature[5] != ATTexture) {
+		log_error("  %s: isn't a texture!\n", input_path.c_str());
+		SDL_RWclose(input);
+		return false;
+	}
+
+	SDL_Surface* loaded = IMG_LoadTyped_RW(input, 1, "PNG");
+	if (loaded == nullptr) {
+		log_error("  %s: couldn't decode the image! Error: %s\n", input_path.c_str(), IMG_GetError());
+		return false;
+	}
+
+	// the header stores the size in 16 bits each
+	if (loaded->w > USHRT_MAX || loaded->h > USHRT_MAX) {
+		log_error("  %s: %dx%d is too large, the maximum is %ux%u!\n", input_path.c_str(), loaded->w, loaded->h, USHRT_MAX, USHRT_MAX);
+		SDL_FreeSurface(loaded);
+		return false;
+	}
+
+	RawTextureHeader header;
+	header.format = format;
+	header.width = static_cast<ushort>(loaded->w);
+	header.height = static_cast<ushort>(loaded->h);
+
+	SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, header.get_sdl_format(), 0);
+	SDL_FreeSurface(loaded);
+	if (surface == nullptr) {
+		log_error("  %s: couldn't convert the image! Error: %s\n", input_path.c_str(), SDL_GetError());
+		return false;
+	}
+
+	// pack the rows tightly
+	size_t row_size = static_cast<size_t>(surface->w) * 4;
+	vector<Uint8> pixels(row_size * surface->h);
+	for (int y = 0; y < surface->h; y++)
+		memcpy(pixels.data() + y * row_size, static_cast<Uint8*>(surface->pixels) + y * surface->pitch, row_size);
+	SDL_FreeSurface(surface);
+
+	if (premultiply) {
+		header.flags |= RawTextureHeader::FLAG_PREMULTIPLIED;
+		for (size_t i = 0; i < pixels.size(); i += 4)
+			for (size_t c = 0; c < 3; c++)
+				pixels[i + c] = static_cast<Uint8>((pixels[i + c] * pixels[i + 3] + 127) / 255);
+	}
+
+	// keep the pixels uncompressed if compressing doesn't make them smaller
+	vector<Uint8> compressed;
+	if (compress)
+		compressed = LZ4::compress(pixels.data(), pixels.size());
+	bool is_compressed = compress && compressed.size() < pixels.size();
+	const vector<Uint8>& data = is_compressed ? compressed : pixels;
+
+	if (data.size() > UINT_MAX) {
+		log_error("  %s: %zu bytes of pixel data is too large!\n", input_path.c_str(), data.size());
+		return false;
+	}
+
+	if (is_compressed)
+		header.flags |= RawTextureHeader::FLAG_LZ4;
+	header.data_size = static_cast<uint>(data.size());
+
+	unsigned char header_bytes[RawTextureHeader::SIZE];
+	header.write(header_bytes);
+	signature[5] = ATRawTexture;
+
+	SDL_RWops* output = SDL_RWFromFile(output_path.c_str(), "wb");
+	if (output == nullptr) {
+		log_error("  %s: couldn't be written! Error: %s\n", output_path.c_str(), SDL_GetError());
+		return false;
+	}
+
+	bool is_written =
+		SDL_RWwrite(output, signature, sizeof(signature), 1) == 1 &&
+		SDL_RWwrite(output, header_bytes, sizeof(header_bytes), 1) == 1 &&
+		SDL_RWwrite(output, data.data(), data.size(), 1) == 1;
+	if (SDL_RWclose(output) != 0)
+		is_written = false;
+
+	if (!is_written) {
+		log_error("  %s: couldn't be written! Error: %s\n", output_path.c_str(), SDL_GetError());
+		// don't leave a partial texture behind
+		error_code error;
+		remove(path(output_path), error);
+		return false;
+	}
+
+	log_info(
+		"  %s -> %s: %ux%u, %u bytes%s\n",
+		input_path.c_str(), output_path.c_str(), header.width, header.height, header.data_size,
+		is_compressed ? " (LZ4)" : ""
+	);
+	return true;
+}
+
+int RawTexture::convert(const string& input_path, const string& output_path, const RawPixelFormat& format, const bool& premultiply, const bool& compress) {
+	if (SDL_Init(0) < 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+		log_error("Couldn't initialize SDL_image! Error: %s\n", IMG_GetError());
+		return 1;
+	}
+
+	log_info(
+		"Converting '%s' to raw %s textures%s%s.\n",
+		input_path.c_str(), format == RPFRGBA ? "RGBA" : "BGRA",
+		premultiply ? ", premultiplied" : "", compress ? ", LZ4 compressed" : ""
+	);
+
+	uint failed = 0;
+	if (is_directory(input_path)) {
+		error_code error;
+		create_directories(output_path, error);
+
+		for (const auto& entry : directory_iterator(input_path)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".catex") {
+				string output_file = (path(output_path) / entry.path().filename()).string();
+				if (!convert_file(entry.path().string(), output_file, format, premultiply, compress))
+					failed++;
+			}
+		}
+	}
+	else if (!convert_file(input_path, output_path, format, premultiply, compress)) {
+		failed++;
+	}
+
+	IMG_Quit();
+	SDL_Quit();
+
+	return failed == 0 ? 0 : 1;
+}
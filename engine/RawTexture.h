@@ -0,0 +1,52 @@
+#pragma once
+#include <SDL.h>
+#include <SDL_image.h>
+#include <string>
+#include "common.h"
+
+using namespace std;
+
+// byte order of the pixels of a raw texture
+enum RawPixelFormat {
+	RPFRGBA,
+	RPFBGRA
+};
+
+// header of a raw texture asset (ATRawTexture), follows the asset signature and type.
+// a raw texture stores it's pixels ready to be uploaded to the GPU as they are,
+// so loading it doesn't need a PNG decode. numbers are big endian like in other asset headers:
+//   format (1 byte), flags (1 byte), width (2 bytes), height (2 bytes), pixel data size (4 bytes)
+struct RawTextureHeader {
+	static const size_t SIZE = 10;
+	// the colors are multiplied by the alpha
+	static const Uint8 FLAG_PREMULTIPLIED = 0b01;
+	// the pixel data is a LZ4 block
+	static const Uint8 FLAG_LZ4 = 0b10;
+
+	RawPixelFormat format = RPFBGRA;
+	Uint8 flags = 0;
+	ushort width = 0;
+	ushort height = 0;
+	// size of the stored pixel data, compressed or not
+	uint data_size = 0;
+
+	void read(const unsigned char* bytes);
+	void write(unsigned char* bytes) const;
+
+	Uint32 get_sdl_format() const;
+	bool is_premultiplied() const;
+	bool is_compressed() const;
+};
+
+namespace RawTexture {
+	// reads the header and pixel data that follow the asset type in io, decompressing it if needed,
+	// returns nullptr and sets the SDL error on failure
+	SDL_Surface* decode(SDL_RWops* io, RawTextureHeader& header);
+
+	// divides the colors of premultiplied 32-bit pixels by their alpha
+	void unpremultiply(SDL_Surface* surface);
+
+	// converts a PNG .catex file, or every .catex file in a directory, to raw textures,
+	// the results are logged and the return value is the process exit code
+	int convert(const string& input_path, const string& output_path, const RawPixelFormat& format, const bool& premultiply, const bool& compress);
+}
@@ -23,9 +23,7 @@ Texture* Sprite::get_texture() const {
 	return texture;
 }
 
-void Sprite::draw(SDL_Renderer* renderer, const RendererState& renderer_state) const {
-	if (texture == nullptr) return;
-
+SDL_FRect Sprite::get_output_rect() const {
 	Transform resulting_transform = get_calculated_transform();
 
 	auto output_rect = 
@@ -72,13 +70,35 @@ void Sprite::draw(SDL_Renderer* renderer, const RendererState& renderer_state) c
 		break;
 	}
 
-	// apply window scaling
-	float scaling = renderer_state.scaling;
+	return output_rect;
+}
+
+bool Sprite::is_visible() const {
+	if (texture == nullptr || opacity <= 0)
+		return false;
 
-	output_rect.x = output_rect.x * scaling;
-	output_rect.y = output_rect.y * scaling;
-	output_rect.w = output_rect.w * scaling;
-	output_rect.h = output_rect.h * scaling;
+	SDL_FRect output_rect = get_output_rect();
+
+	// a rotated sprite stays within the circle around it's center (the rotation origin),
+	// so the rectangle is expanded to the square around that circle
+	if (get_calculated_transform().rotation != 0) {
+		float center_x = output_rect.x + output_rect.w / 2;
+		float center_y = output_rect.y + output_rect.h / 2;
+		float radius = sqrtf(output_rect.w * output_rect.w + output_rect.h * output_rect.h) / 2;
+
+		output_rect = { center_x - radius, center_y - radius, radius * 2, radius * 2 };
+	}
+
+	return
+		output_rect.x < WINDOW_WIDTH && output_rect.x + output_rect.w > 0 &&
+		output_rect.y < WINDOW_HEIGHT && output_rect.y + output_rect.h > 0;
+}
+
+void Sprite::draw(SDL_Renderer* renderer, const RendererState& renderer_state) const {
+	if (texture == nullptr) return;
+
+	Transform resulting_transform = get_calculated_transform();
+	SDL_FRect output_rect = get_output_rect();
 
 	const SDL_Rect* cr = nullptr;
 	if (clip_rect)
@@ -87,10 +107,24 @@ void Sprite::draw(SDL_Renderer* renderer, const RendererState& renderer_state) c
 	// apply opacity
 	SDL_SetTextureAlphaMod(texture->get_raw(), static_cast<Uint8>(opacity * 255));
 
+	// apply color modulation only if it's set, as most sprites aren't tinted.
+	// premultiplied colors aren't scaled by the alpha modulation, so they are faded with the color modulation
+	float color_fade = texture->has_premultiplied_alpha() ? opacity : 1;
+	bool is_tinted = color_mod.r != 255 || color_mod.g != 255 || color_mod.b != 255 || color_fade < 1;
+	if (is_tinted)
+		SDL_SetTextureColorMod(
+			texture->get_raw(),
+			static_cast<Uint8>(color_mod.r * color_fade),
+			static_cast<Uint8>(color_mod.g * color_fade),
+			static_cast<Uint8>(color_mod.b * color_fade)
+		);
+
 	SDL_RenderCopyExF(renderer, texture->get_raw(), cr, &output_rect, resulting_transform.rotation, nullptr, SDL_FLIP_NONE);
 
-	// restore opacity for other sprites
+	// restore opacity and color for other sprites
 	SDL_SetTextureAlphaMod(texture->get_raw(), 255);
+	if (is_tinted)
+		SDL_SetTextureColorMod(texture->get_raw(), 255, 255, 255);
 }
 
 void Sprite::set_display_size(const vec2& size) {
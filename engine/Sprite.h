@@ -30,6 +30,8 @@ public:
 	HorizontalAlignment horizontal_alignment = Left;
 
 	float opacity = 1;
+	// color multiplied with the texture's colors when drawing
+	SDL_Color color_mod = { 255, 255, 255, 255 };
 
 	Sprite(
 		Texture* texture, 
@@ -47,9 +49,12 @@ public:
 
 	void change_texture(Texture* new_texture);
 	vec2 get_size() const;
+	// returns the rectangle the sprite is drawn to, without rotation
+	SDL_FRect get_output_rect() const;
 	Texture* get_texture() const;
 	void set_display_size(const vec2& size);
 	virtual void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const override;
+	virtual bool is_visible() const override;
 
 	// Transform methods
 
@@ -14,6 +14,9 @@ SDL_FRect Texture::get_rect(const float& x, const float& y, const float& scale)
 ushort Texture::get_width() const { return w; }
 ushort Texture::get_height() const { return h; }
 
+bool Texture::has_premultiplied_alpha() const { return premultiplied_alpha; }
+void Texture::set_premultiplied_alpha(const bool& state) { premultiplied_alpha = state; }
+
 SDL_Texture* Texture::get_raw() const { return texture; }
 void Texture::destroy() {
 	if (texture == nullptr)
@@ -25,6 +28,16 @@ void Texture::destroy() {
 	h = 0;
 }
 
+void Texture::replace(const Texture& other) {
+	if (texture != other.texture)
+		destroy();
+
+	w = other.w;
+	h = other.h;
+	texture = other.texture;
+	premultiplied_alpha = other.premultiplied_alpha;
+}
+
 bool Texture::operator==(const Texture& other) const {
 	return texture == other.get_raw();
 }
@@ -8,6 +8,8 @@ class Texture {
 	ushort w;
 	ushort h;
 	SDL_Texture* texture;
+	// the colors are multiplied by the alpha, so fading has to scale the colors too
+	bool premultiplied_alpha = false;
 
 public:
 	Texture(const ushort& w, const ushort& h, SDL_Texture* texture) : w(w), h(h), texture(texture) {}
@@ -17,8 +19,13 @@ public:
 	SDL_FRect get_rect(const float& x = 0, const float& y = 0, const float& scale = 1) const;
 	ushort get_width() const;
 	ushort get_height() const;
+	bool has_premultiplied_alpha() const;
+	void set_premultiplied_alpha(const bool& state);
 	virtual SDL_Texture* get_raw() const;
 	virtual void destroy();
+	// destroys the raw texture and takes the other's in it's place,
+	// so pointers to this texture stay valid when it's reloaded
+	void replace(const Texture& other);
 
 	bool operator==(const Texture& other) const;
 	bool operator!=(const Texture& other) const;
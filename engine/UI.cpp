@@ -98,6 +98,10 @@ void UIElement::update(const float& delta, GameState& game_state) {
 
 	if ((m_state.previous_mouse_pos - m_state.mouse_pos).len() != 0.0F)	on_mouse_move(game_state);
 
+	if (mouse_inside && !was_mouse_inside)	on_mouse_enter(game_state);
+	if (!mouse_inside && was_mouse_inside)	on_mouse_leave(game_state);
+	was_mouse_inside = mouse_inside;
+
 	update_layout(true);
 
 	for (auto& el : children)
@@ -146,14 +150,10 @@ void UI::draw(SDL_Renderer* renderer, const RendererState& renderer_state) const
 }
 
 void UI::update(const float& delta, GameState& game_state) {
-	scaling_just_changed = scaling != game_state.renderer_state.scaling;
-	scaling = game_state.renderer_state.scaling;
 	if (root_element)
 		root_element->update(delta, game_state);
 }
 
-const float& UI::get_scaling() const { return scaling; }
-
 void UISprite::draw(SDL_Renderer* renderer, const RendererState& renderer_state) const {
 	if (texture == nullptr) return;
 
@@ -287,8 +287,8 @@ void UISprite::draw(SDL_Renderer* renderer, const RendererState& renderer_state)
 
 	for (SDL_FRect* tr : to_transform) {
 		// apply normal scaling
-		float x_ratio = resulting_transform.scale.x * renderer_state.scaling;
-		float y_ratio = resulting_transform.scale.y * renderer_state.scaling;
+		float x_ratio = resulting_transform.scale.x;
+		float y_ratio = resulting_transform.scale.y;
 
 		// apply display size scaling
 		if (display_size != nullopt) {
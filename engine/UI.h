@@ -39,6 +39,7 @@ enum UIListenerType {
 	LMBDown, LMBUp,
 	RMBDown, RMBUp,
 	MouseMove,
+	MouseEnter, MouseLeave,
 	KeyDown, KeyUp
 };
 
@@ -54,11 +55,13 @@ protected:
 		{ LMBDown, {} }, { LMBUp, {} },
 		{ RMBDown, {} }, { RMBUp, {} },
 		{ MouseMove, {} },
+		{ MouseEnter, {} }, { MouseLeave, {} },
 		{ KeyDown, {} }, { KeyUp, {} },
 	};
 
 	bool is_pressed_l = false;
 	bool is_pressed_r = false;
+	bool was_mouse_inside = false;
 
 	virtual vec2 get_min_dimensions() const = 0;
 	virtual void shrink_to_fit();
@@ -117,6 +120,8 @@ public:
 	virtual void on_rmb_up(GameState& game_state)		{ for (auto& pair : listeners.at(RMBUp))		pair.second(game_state, this); }
 
 	virtual void on_mouse_move(GameState& game_state)	{ for (auto& pair : listeners.at(MouseMove))	pair.second(game_state, this); }
+	virtual void on_mouse_enter(GameState& game_state)	{ for (auto& pair : listeners.at(MouseEnter))	pair.second(game_state, this); }
+	virtual void on_mouse_leave(GameState& game_state)	{ for (auto& pair : listeners.at(MouseLeave))	pair.second(game_state, this); }
 
 	virtual void on_key_down(GameState& game_state)		{ for (auto& pair : listeners.at(KeyDown))		pair.second(game_state, this); }
 	virtual void on_key_up(GameState& game_state)		{ for (auto& pair : listeners.at(KeyDown))		pair.second(game_state, this); }
@@ -194,10 +199,7 @@ public:
 };
 
 class UI : public Drawable, public Updatable {
-	float scaling = 1;
 public:
-	bool scaling_just_changed = false;
-
 	shared_ptr<UIElement> root_element;
 	SDL_Renderer* renderer;
 
@@ -205,5 +207,4 @@ public:
 
 	void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const override;
 	void update(const float& delta, GameState& game_state) override;
-	const float& get_scaling() const;
 };
\ No newline at end of file
@@ -14,7 +14,6 @@ class Text : public VisualUIElement {
 			delete texture;
 		}
 
-		//texture = font->render(ui->renderer, content, color, ui->get_scaling());
 		texture = font->render(ui->renderer, content, color, 1);
 		set_dimensions(vec2(texture->get_width(), texture->get_height()));
 	}
@@ -48,13 +47,4 @@ public:
 	}
 
 	const SDL_Color& get_color() const { return color; }
-
-	void update(const float& delta, GameState& game_state) {
-		if (ui->scaling_just_changed) {
-			render_text();
-			//set_scale(1 / ui->get_scaling());
-		}
-
-		VisualUIElement::update(delta, game_state);
-	}
 };
\ No newline at end of file
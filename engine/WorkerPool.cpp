@@ -0,0 +1,88 @@
+#include "../engine/WorkerPool.h"
+
+WorkerPool::WorkerPool(const uint& thread_count) {
+	for (uint i = 0; i < thread_count; i++)
+		threads.emplace_back(&WorkerPool::work, this);
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		lock_guard<mutex> lock(job_mutex);
+		is_stopping = true;
+	}
+	job_available.notify_all();
+
+	for (thread& worker : threads)
+		worker.join();
+}
+
+uint WorkerPool::get_thread_count() const { return static_cast<uint>(threads.size()); }
+
+void WorkerPool::run_job(unique_lock<mutex>& lock) {
+	while (next_index < job_count) {
+		uint index = next_index++;
+
+		lock.unlock();
+		exception_ptr exception;
+		try {
+			(*job)(index);
+		}
+		catch (...) {
+			exception = current_exception();
+		}
+		lock.lock();
+
+		if (exception && !job_exception)
+			job_exception = exception;
+
+		finished_count++;
+		if (finished_count == job_count)
+			job_done.notify_all();
+	}
+}
+
+void WorkerPool::work() {
+	unique_lock<mutex> lock(job_mutex);
+
+	while (true) {
+		job_available.wait(lock, [this]() { return is_stopping || next_index < job_count; });
+		if (is_stopping)
+			return;
+
+		run_job(lock);
+	}
+}
+
+void WorkerPool::parallel_for(const uint& count, const function<void(uint)>& func) {
+	if (count == 0)
+		return;
+
+	unique_lock<mutex> lock(job_mutex);
+	job = &func;
+	job_count = count;
+	next_index = 0;
+	finished_count = 0;
+	job_exception = nullptr;
+	job_available.notify_all();
+
+	run_job(lock);
+	job_done.wait(lock, [this]() { return finished_count == job_count; });
+
+	// the workers go back to waiting once the job is reset
+	job = nullptr;
+	job_count = 0;
+	next_index = 0;
+
+	exception_ptr exception = job_exception;
+	job_exception = nullptr;
+	lock.unlock();
+
+	if (exception)
+		rethrow_exception(exception);
+}
+
+WorkerPool& WorkerPool::get() {
+	uint hardware_threads = thread::hardware_concurrency();
+	static WorkerPool pool(hardware_threads > 1 ? hardware_threads - 1 : 1);
+	return pool;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include "common.h"
+
+using namespace std;
+
+// WorkerPool is a set of threads that are kept alive between jobs.
+//
+// a job is a function run for every index of a range, the indices are handed out
+// one by one to the workers and the calling thread, which waits for all of them to finish
+class WorkerPool {
+	vector<thread> threads;
+
+	mutex job_mutex;
+	condition_variable job_available;
+	condition_variable job_done;
+
+	const function<void(uint)>* job = nullptr;
+	uint job_count = 0;
+	uint next_index = 0;
+	uint finished_count = 0;
+	exception_ptr job_exception;
+	bool is_stopping = false;
+
+	// runs the indices of the current job until there are none left, the lock is released while running them
+	void run_job(unique_lock<mutex>& lock);
+	void work();
+
+public:
+	// the calling thread works too, so the pool runs up to thread_count + 1 indices at once
+	WorkerPool(const uint& thread_count);
+	~WorkerPool();
+
+	uint get_thread_count() const;
+
+	// runs func for every index from 0 to count - 1 and returns once all of them are done,
+	// the first exception thrown by func is rethrown here after the other indices finish.
+	// it isn't reentrant: func must not call parallel_for of the same pool
+	void parallel_for(const uint& count, const function<void(uint)>& func);
+
+	// the pool shared by the engine, with a worker for every hardware thread except the calling one
+	static WorkerPool& get();
+};
@@ -30,8 +30,21 @@ public:
 class Drawable {
 public: 
 	virtual void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const = 0;
+	// returns false if drawing would put nothing on the screen, i.e. it's off-screen or fully transparent
+	virtual bool is_visible() const { return true; }
 };
 
+// returns whether the drawable should be drawn and counts it as drawn or culled
+inline bool cull_drawable(const Drawable& drawable, const RendererState& renderer_state) {
+	if (drawable.is_visible()) {
+		renderer_state.drawn_count++;
+		return true;
+	}
+
+	renderer_state.culled_count++;
+	return false;
+}
+
 class Updatable {
 public:
 	virtual void update(const float& delta, GameState& game_state) = 0;
@@ -1,4 +1,6 @@
 #include "../engine/common.h"
+#include <cmath>
+#include <initializer_list>
 
 vec2 vec2::operator+(const vec2& other) const { return vec2(this->x + other.x, this->y + other.y); }
 vec2 vec2::operator-(const vec2& other) const { return vec2(this->x - other.x, this->y - other.y); }
@@ -105,6 +107,114 @@ bool Collision::is_circle_on_circle(
 	return distance_between_circles <= first_circle_radius + second_circle_radius;
 }
 
+// finds the fractions during which a moving point is within radius of a circle
+static bool get_swept_point_in_circle_interval(
+	const vec2& circle_center,
+	const float& radius,
+	const vec2& movement_start,
+	const vec2& movement,
+	float& enter_fraction,
+	float& exit_fraction
+) {
+	// |start + movement * t - center|^2 = radius^2
+	vec2 center_to_start(circle_center, movement_start);
+	float a = vec2::dot(movement, movement);
+	float b = 2 * vec2::dot(center_to_start, movement);
+	float c = vec2::dot(center_to_start, center_to_start) - radius * radius;
+
+	// not moving, the point is either inside the whole time or never
+	if (a == 0) {
+		enter_fraction = -INFINITY;
+		exit_fraction = INFINITY;
+		return c <= 0;
+	}
+
+	float discriminant = b * b - 4 * a * c;
+	if (discriminant < 0)
+		return false;
+
+	float root = sqrtf(discriminant);
+	enter_fraction = (-b - root) / (2 * a);
+	exit_fraction = (-b + root) / (2 * a);
+	return true;
+}
+
+// narrows the fraction interval to where from + step * t is within min and max
+static bool clip_swept_interval(
+	const float& from,
+	const float& step,
+	const float& min,
+	const float& max,
+	float& enter_fraction,
+	float& exit_fraction
+) {
+	if (step == 0)
+		return from >= min && from <= max;
+
+	float first = (min - from) / step;
+	float second = (max - from) / step;
+	if (first > second)
+		std::swap(first, second);
+
+	enter_fraction = fmaxf(enter_fraction, first);
+	exit_fraction = fminf(exit_fraction, second);
+	return enter_fraction <= exit_fraction;
+}
+
+bool Collision::get_swept_point_on_line_interval(
+	const vec2& line_start_point,
+	const vec2& line_end_point,
+	const vec2& movement_start,
+	const vec2& movement_end,
+	const float& distance,
+	float& enter_fraction,
+	float& exit_fraction
+) {
+	vec2 movement(movement_start, movement_end);
+	bool hit = false;
+	float enter = INFINITY;
+	float exit = -INFINITY;
+
+	// the capsule is convex, so the straight movement is inside it during a single interval,
+	// which is the union of the intervals inside the end circles and inside the middle rectangle
+	for (const vec2* center : { &line_start_point, &line_end_point }) {
+		float circle_enter, circle_exit;
+		if (get_swept_point_in_circle_interval(*center, distance, movement_start, movement, circle_enter, circle_exit)) {
+			enter = fminf(enter, circle_enter);
+			exit = fmaxf(exit, circle_exit);
+			hit = true;
+		}
+	}
+
+	vec2 line_vec(line_start_point, line_end_point);
+	float line_length = line_vec.len();
+	if (line_length > 0) {
+		// movement in the segment's space, along the segment and across it
+		vec2 along = line_vec / line_length;
+		vec2 line_to_start(line_start_point, movement_start);
+		float along_start = vec2::dot(line_to_start, along);
+		float along_step = vec2::dot(movement, along);
+		float across_start = along.x * line_to_start.y - along.y * line_to_start.x;
+		float across_step = along.x * movement.y - along.y * movement.x;
+
+		float rect_enter = -INFINITY;
+		float rect_exit = INFINITY;
+		if (
+			clip_swept_interval(along_start, along_step, 0, line_length, rect_enter, rect_exit) &&
+			clip_swept_interval(across_start, across_step, -distance, distance, rect_enter, rect_exit)
+		) {
+			enter = fminf(enter, rect_enter);
+			exit = fmaxf(exit, rect_exit);
+			hit = true;
+		}
+	}
+
+	// only the part of the interval within the movement counts
+	enter_fraction = fmaxf(enter, 0);
+	exit_fraction = fminf(exit, 1);
+	return hit && enter_fraction <= exit_fraction;
+}
+
 float rand_float() {
 	return static_cast<float>(rand() % 1000000) / 1000000;
 }
\ No newline at end of file
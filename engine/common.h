@@ -25,7 +25,7 @@ typedef struct vec2 {
 	vec2(float x, float y) : x(x), y(y) {}
 	vec2(const vec2& start_point, const vec2& end_point) : x(end_point.x - start_point.x), y(end_point.y - start_point.y) {}
 	vec2(std::pair<float, float> params) : x(params.first), y(params.second) {}
-	vec2(const vec2& other) : x(other.x), y(other.y) {}
+	vec2(const vec2& other) = default;
 
 	vec2 operator+(const vec2& other) const;
 	vec2 operator-(const vec2& other) const;
@@ -86,6 +86,18 @@ public:
 		const vec2& second_circle, 
 		const float& second_circle_radius
 	);
+	// finds the fractions of the movement, within 0 and 1, during which a point moving from
+	// movement_start to movement_end is within distance of the segment (inside it's capsule),
+	// returns false if the point doesn't get close enough
+	static bool get_swept_point_on_line_interval(
+		const vec2& line_start_point,
+		const vec2& line_end_point,
+		const vec2& movement_start,
+		const vec2& movement_end,
+		const float& distance,
+		float& enter_fraction,
+		float& exit_fraction
+	);
 };
 
 // gives a random float between 0 and 1
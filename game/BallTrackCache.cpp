@@ -0,0 +1,178 @@
+#include "BallTrackCache.h"
+#include <cmath>
+#include <algorithm>
+
+BTCreationException::BTCreationException(const char* message) { msg = message; }
+const char* BTCreationException::what() { return msg; }
+
+BallTrackCache BallTrackCache::build(const vector<vec2>& points) {
+	BallTrackCache cache;
+	// save the given points for later use
+	cache.points = points;
+	// if there aren't enough points to construct a track, throw an error
+	if (points.size() < 2) {
+		throw new BTCreationException("track point count is less than 2");
+	}
+	// construct track segments for each point pair
+	for (int i = 1; i < points.size(); i++) {
+		const vec2& point2 = points[i];
+		const vec2& point1 = points[i - 1];
+		TrackSegment segment;
+		// using Pythagoras theorem to find the length, angle and cosine/sine of the angle of the segment
+		float w = point2.x - point1.x;
+		float h = point2.y - point1.y;
+		segment.length = hypotf(w, h);
+		segment.angle_cos = w / segment.length;
+		segment.angle_sin = h / segment.length;
+		segment.angle = acosf(segment.angle_cos);
+
+		// as cmath's acos doesn't give negative values, we need to account for negative angles
+		if (segment.angle_cos < 0)
+			segment.angle -= static_cast<float>(M_PI);
+
+		// if the height of the segment's right triangle is negative
+		// (the segment's end point is closer to the top boundary than the start point),
+		// the angle needs to be sign-inverted
+		if (h < 0) { 
+			segment.angle *= -1;
+		}
+		// if the width of the segment's right triangle is negative
+		// (the segment's end point is closer to the left boundary than the start point),
+		// the angle needs to be mirrored along the center point (add 180deg)
+		if (w < 0) {
+			segment.angle += static_cast<float>(M_PI);
+		}
+		// convert given angle to standard normalized degree form
+		segment.angle = normalize_angle(rad_to_deg(segment.angle));
+
+		cache.segments.push_back(segment);
+	}
+
+	// calculating and caching the total length of the track
+	// and the track length before each of the segments
+	cache.total_length = 0.0F;
+	for (const TrackSegment& segment : cache.segments) {
+		cache.arrays.start_length.push_back(cache.total_length);
+		cache.total_length += segment.length;
+	}
+
+	// the end is found the same way as the balls are positioned
+	cache.end_position = cache.position_at(cache.total_length);
+
+	cache.fill_arrays();
+	return cache;
+}
+
+optional<uint> BallTrackCache::find_segment(const float& position) const {
+	if (position > total_length)
+		return nullopt;
+
+	// the segment at the position's index in the table is the right one or next to it,
+	// as the segment lengths only differ by a tiny fraction of the spacing
+	if (uniform_spacing > 0) {
+		uint cursor = static_cast<uint>(max(position / uniform_spacing, 0.0F));
+		return find_segment_from(cursor, position);
+	}
+
+	// a segment contains the positions up to and including it's end, which is the next segment's start,
+	// so the segment is the first one with it's end at or after the position
+	const vector<float>& starts = arrays.start_length;
+	auto next_start = lower_bound(starts.begin() + 1, starts.end(), position);
+	return static_cast<uint>(next_start - (starts.begin() + 1));
+}
+
+optional<uint> BallTrackCache::find_segment_from(uint& cursor, const float& position) const {
+	if (position > total_length)
+		return nullopt;
+
+	const vector<float>& starts = arrays.start_length;
+	uint last_segment = static_cast<uint>(segments.size() - 1);
+	cursor = min(cursor, last_segment);
+
+	// the position is in the cursor segment if it's after the segment's start and at or before it's end
+	while (cursor > 0 && position <= starts[cursor])
+		cursor--;
+	while (cursor < last_segment && position > starts[cursor + 1])
+		cursor++;
+
+	return cursor;
+}
+
+vec2 BallTrackCache::position_at(const float& position) const {
+	uint segment_index = find_segment(position).value_or(static_cast<uint>(segments.size() - 1));
+	const TrackSegment& segment = segments[segment_index];
+	float segment_position = position - arrays.start_length[segment_index];
+
+	return vec2(
+		points[segment_index].x + segment_position * segment.angle_cos,
+		points[segment_index].y + segment_position * segment.angle_sin
+	);
+}
+
+void BallTrackCache::fill_arrays() {
+	arrays.start_x.clear();
+	arrays.start_y.clear();
+	arrays.angle_cos.clear();
+	arrays.angle_sin.clear();
+	arrays.angle.clear();
+
+	for (uint i = 0; i < segments.size(); i++) {
+		const TrackSegment& segment = segments[i];
+
+		arrays.start_x.push_back(points[i].x);
+		arrays.start_y.push_back(points[i].y);
+		arrays.angle_cos.push_back(segment.angle_cos);
+		arrays.angle_sin.push_back(segment.angle_sin);
+		arrays.angle.push_back(segment.angle);
+	}
+
+	grid.build(points);
+}
+
+void TrackGrid::build(const vector<vec2>& points) {
+	vec2 min_point = points[0];
+	vec2 max_point = points[0];
+	for (const vec2& point : points) {
+		min_point = vec2(min(min_point.x, point.x), min(min_point.y, point.y));
+		max_point = vec2(max(max_point.x, point.x), max(max_point.y, point.y));
+	}
+
+	origin = min_point;
+	columns = static_cast<int>((max_point.x - min_point.x) / CELL_SIZE) + 1;
+	rows = static_cast<int>((max_point.y - min_point.y) / CELL_SIZE) + 1;
+
+	// the cells of a segment's bounding box
+	auto get_cell_range = [&](uint segment, int& min_column, int& max_column, int& min_row, int& max_row) {
+		const vec2& start = points[segment];
+		const vec2& end = points[segment + 1];
+		min_column = static_cast<int>((min(start.x, end.x) - origin.x) / CELL_SIZE);
+		max_column = min(static_cast<int>((max(start.x, end.x) - origin.x) / CELL_SIZE), columns - 1);
+		min_row = static_cast<int>((min(start.y, end.y) - origin.y) / CELL_SIZE);
+		max_row = min(static_cast<int>((max(start.y, end.y) - origin.y) / CELL_SIZE), rows - 1);
+	};
+
+	// count the segments of every cell first, so the cells are laid out in one array
+	uint segment_count = static_cast<uint>(points.size() - 1);
+	vector<uint> counts(static_cast<size_t>(columns) * rows + 1, 0);
+	int min_column, max_column, min_row, max_row;
+	for (uint segment = 0; segment < segment_count; segment++) {
+		get_cell_range(segment, min_column, max_column, min_row, max_row);
+		for (int row = min_row; row <= max_row; row++)
+			for (int column = min_column; column <= max_column; column++)
+				counts[row * columns + column]++;
+	}
+
+	cell_starts.assign(counts.size(), 0);
+	for (size_t cell = 1; cell < counts.size(); cell++)
+		cell_starts[cell] = cell_starts[cell - 1] + counts[cell - 1];
+
+	// segments are added in increasing order, so every cell's indices are sorted
+	cell_segments.assign(cell_starts.back(), 0);
+	vector<uint> fill(cell_starts.begin(), cell_starts.end() - 1);
+	for (uint segment = 0; segment < segment_count; segment++) {
+		get_cell_range(segment, min_column, max_column, min_row, max_row);
+		for (int row = min_row; row <= max_row; row++)
+			for (int column = min_column; column <= max_column; column++)
+				cell_segments[fill[row * columns + column]++] = segment;
+	}
+}
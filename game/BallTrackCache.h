@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <cmath>
+#include "../engine/common.h"
+#include "../engine/Kernels.h"
+
+using namespace std;
+
+struct TrackSegment {
+	float angle = 0;
+	float angle_cos = 0;
+	float angle_sin = 0;
+	float length = 0;
+};
+
+// exception thrown upon construction of BallTrack (i.e. there are less than 2 points for the track)
+class BTCreationException : public exception {
+	const char* msg;
+public:
+	BTCreationException(const char* message);
+	const char* what();
+};
+
+// uniform grid over the track segments, for testing only the segments near a point
+struct TrackGrid {
+	static constexpr float CELL_SIZE = 64.0F;
+
+	vec2 origin;
+	int columns = 0;
+	int rows = 0;
+	// segment indices of every cell are cell_segments[cell_starts[cell]] up to cell_segments[cell_starts[cell + 1]],
+	// in increasing order
+	vector<uint> cell_starts;
+	vector<uint> cell_segments;
+
+	// puts every segment in the cells overlapped by it's bounding box
+	void build(const vector<vec2>& points);
+
+	// calls func with the index of every segment in the cells overlapped by the square around the center,
+	// a segment overlapping several cells is passed once for each of them
+	template<typename Func>
+	void for_each_near(const vec2& center, const float& reach, Func func) const {
+		if (columns == 0)
+			return;
+
+		int min_column = max(static_cast<int>(floorf((center.x - reach - origin.x) / CELL_SIZE)), 0);
+		int max_column = min(static_cast<int>(floorf((center.x + reach - origin.x) / CELL_SIZE)), columns - 1);
+		int min_row = max(static_cast<int>(floorf((center.y - reach - origin.y) / CELL_SIZE)), 0);
+		int max_row = min(static_cast<int>(floorf((center.y + reach - origin.y) / CELL_SIZE)), rows - 1);
+
+		for (int row = min_row; row <= max_row; row++) {
+			for (int column = min_column; column <= max_column; column++) {
+				uint cell = static_cast<uint>(row * columns + column);
+				for (uint i = cell_starts[cell]; i < cell_starts[cell + 1]; i++)
+					func(cell_segments[i]);
+			}
+		}
+	}
+};
+
+// cache for precomputed values to quickly draw the ball track
+struct BallTrackCache {
+	vector<vec2> points;
+	vector<TrackSegment> segments;
+	// the same segment values in a layout for the batched kernels,
+	// arrays.start_length holds the track length before each segment
+	TrackArrays arrays;
+	float total_length = 0;
+	// position of the track's end, where the death window is
+	vec2 end_position;
+	// average segment length of a track tessellated from a spline, which has evenly spaced points,
+	// 0 for authored polylines. the segment of a position is then found by it's index in the table
+	float uniform_spacing = 0;
+	// grid for collision tests against the segments
+	TrackGrid grid;
+
+	// computes the segments, lengths and end position of a track going through the points,
+	// throws BTCreationException if there are less than 2 points
+	static BallTrackCache build(const vector<vec2>& points);
+
+	// finds the index of the segment the track position is in, directly on evenly spaced tracks
+	// or with a binary search over the start lengths otherwise,
+	// positions before the track are in the first segment, returns nullopt for positions past the end
+	optional<uint> find_segment(const float& position) const;
+
+	// finds the same segment as find_segment by walking from the cursor segment,
+	// which is moved to the found segment. positions close to the cursor's are found in a few steps,
+	// so a cursor that follows moving balls makes the lookups nearly constant time
+	optional<uint> find_segment_from(uint& cursor, const float& position) const;
+
+	// gets the point at the track position, the same way the balls are positioned
+	// (from the start point of it's segment), positions outside the track continue it's first or last segment
+	vec2 position_at(const float& position) const;
+
+	// fills the arrays from the points, segments and start lengths (arrays.start_length) and builds the grid
+	void fill_arrays();
+};
@@ -0,0 +1,84 @@
+#include "BallTrackSet.h"
+#include <algorithm>
+
+BallTrackSet::BallTrackSet(shared_ptr<EntityManager> entity_manager) : entity_manager(entity_manager) {}
+
+void BallTrackSet::finish_level(GameState& game_state, const GameSection& section) {
+	is_fading_out_to_screen = true;
+
+	game_state.fade_in([&, section]() {
+		// delete Level to prepare for the next load
+		entity_manager->schedule_to_delete("level");
+
+		game_state.set_section(section);
+		game_state.fade_out([]() {}, 1.0F);
+	}, 1.0F);
+}
+
+void BallTrackSet::draw(SDL_Renderer* renderer, const RendererState& renderer_state) const {
+	for (const shared_ptr<BallTrack>& track : tracks)
+		track->draw(renderer, renderer_state);
+}
+
+void BallTrackSet::update(const float& delta, GameState& game_state) {
+	// every track changes only it's own balls, so the tracks are simulated at the same time,
+	// and their score, sounds and particles are applied afterwards in the same order every time
+	if (tracks.size() > 1) {
+		WorkerPool::get().parallel_for(static_cast<uint>(tracks.size()), [&](uint i) {
+			tracks[i]->simulate(delta, game_state);
+		});
+	}
+	else if (tracks.size() == 1)
+		tracks[0]->simulate(delta, game_state);
+
+	for (const shared_ptr<BallTrack>& track : tracks)
+		track->apply_events(game_state);
+
+	if (is_fading_out_to_screen)
+		return;
+
+	auto has_failed = [](const shared_ptr<BallTrack>& track) { return track->has_failed(); };
+	if (any_of(tracks.begin(), tracks.end(), has_failed)) {
+		// a ball reaching any death window ends the level, the balls of the other tracks rush out too
+		for (const shared_ptr<BallTrack>& track : tracks)
+			track->fail();
+
+		auto has_balls_on_track = [](const shared_ptr<BallTrack>& track) { return track->has_balls_on_track(); };
+		if (none_of(tracks.begin(), tracks.end(), has_balls_on_track))
+			finish_level(game_state, DeathScreen);
+	}
+	else {
+		auto is_cleared = [](const shared_ptr<BallTrack>& track) { return track->is_cleared(); };
+		if (all_of(tracks.begin(), tracks.end(), is_cleared))
+			finish_level(game_state, WinScreen);
+	}
+}
+
+BallColorMask BallTrackSet::get_current_colors() const {
+	BallColorMask colors = 0;
+	for (const shared_ptr<BallTrack>& track : tracks)
+		colors |= track->get_current_colors();
+
+	return colors;
+}
+
+optional<BallTrackCollisionData> BallTrackSet::get_swept_collision_data(
+	const vec2& start,
+	const vec2& end,
+	const float& point_radius,
+	shared_ptr<BallTrack>& hit_track
+) const {
+	optional<BallTrackCollisionData> earliest_collision;
+
+	// every track's grid only has cells around it's own segments,
+	// so the tracks far from the movement are skipped right away
+	for (const shared_ptr<BallTrack>& track : tracks) {
+		auto collision_data = track->get_swept_collision_data(start, end, point_radius);
+		if (collision_data && (!earliest_collision || collision_data->time_of_impact < earliest_collision->time_of_impact)) {
+			earliest_collision = collision_data;
+			hit_track = track;
+		}
+	}
+
+	return earliest_collision;
+}
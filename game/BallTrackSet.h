@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <optional>
+#include "../engine/EntityManager.h"
+#include "../engine/WorkerPool.h"
+#include "Balls.h"
+
+using namespace std;
+
+// the ball tracks of a level, which run at the same time.
+// the level is won once the balls of every track are broken
+// and lost once a ball of any track reaches it's death window
+class BallTrackSet : public Drawable, public Updatable {
+	// pointer to EntityManager for Level finish
+	shared_ptr<EntityManager> entity_manager;
+
+	// set to true when the level is being finished
+	bool is_fading_out_to_screen = false;
+
+	// fades to the section and deletes the level
+	void finish_level(GameState& game_state, const GameSection& section);
+
+public:
+	vector<shared_ptr<BallTrack>> tracks;
+
+	BallTrackSet(shared_ptr<EntityManager> entity_manager);
+
+	void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const override;
+	// simulates the tracks on the worker pool and then applies their events in order
+	void update(const float& delta, GameState& game_state) override;
+
+	// gets the set of colors of all balls on all tracks
+	BallColorMask get_current_colors() const;
+
+	// checks for the earliest collision of a moving circle with the balls of any track,
+	// the hit track is written to hit_track. returns nullopt if there was no collision
+	optional<BallTrackCollisionData> get_swept_collision_data(
+		const vec2& start,
+		const vec2& end,
+		const float& point_radius,
+		shared_ptr<BallTrack>& hit_track
+	) const;
+};
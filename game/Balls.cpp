@@ -1,5 +1,7 @@
 #include "Balls.h"
 
+bool Ball::use_tinted_sheet = false;
+
 Ball::Ball(
 	shared_ptr<AssetManager> asset_manager,
 	BallColor color,
@@ -7,9 +9,7 @@ Ball::Ball(
 )
 	:
 	Sprite(
-		&asset_manager->get_texture(
-			BALL_COLOR_TEXTURE_MAP.at(color)	// gets texture name by BallColor value
-		),
+		&get_color_texture(*asset_manager, color),	// gets the spritesheet by BallColor value
 		position
 	),
 	color(color),
@@ -21,12 +21,17 @@ Ball::Ball(
 	sheen_sprite->vertical_alignment = Middle;
 	sheen_sprite->horizontal_alignment = Center;
 
+	if (use_tinted_sheet)
+		color_mod = BALLCOLOR_TO_RGB_MAP.at(color);
+
 	set_display_size(vec2(BALL_SIZE, BALL_SIZE));
 	// align the ball to the absolute center
 	vertical_alignment = Middle;
 	horizontal_alignment = Center;
 }
 
+bool Ball::is_visible() const { return show && Sprite::is_visible(); }
+
 void Ball::draw(SDL_Renderer* renderer, const RendererState& renderer_state) const {
 	Sprite::draw(renderer, renderer_state);
 	sheen_sprite->draw(renderer, renderer_state);
@@ -70,17 +75,97 @@ void Ball::set_ball_angle(const float& angle) {
 
 void Ball::change_color(BallColor new_color) {
 	color = new_color;
-	change_texture(
-		&asset_manager->get_texture(
-			BALL_COLOR_TEXTURE_MAP.at(color)
-		)
-	);
+	change_texture(&get_color_texture(*asset_manager, color));
+
+	if (use_tinted_sheet)
+		color_mod = BALLCOLOR_TO_RGB_MAP.at(color);
+}
+
+Texture& Ball::get_color_texture(AssetManager& asset_manager, BallColor color) {
+	if (use_tinted_sheet)
+		return asset_manager.get_texture(BALL_TINTED_SHEET_TEXTURE);
+
+	return asset_manager.get_texture(BALL_COLOR_TEXTURE_MAP.at(color));
+}
+
+void BallChain::move_gap(const uint& index) {
+	while (before_gap.size() > index) {
+		after_gap.push_back(move(before_gap.back()));
+		before_gap.pop_back();
+	}
+	while (before_gap.size() < index) {
+		before_gap.push_back(move(after_gap.back()));
+		after_gap.pop_back();
+	}
+}
+
+uint BallChain::size() const { return static_cast<uint>(before_gap.size() + after_gap.size()); }
+
+Ball& BallChain::operator[](const uint& index) {
+	if (index < before_gap.size())
+		return before_gap[index];
+	return after_gap[after_gap.size() - 1 - (index - before_gap.size())];
+}
+
+const Ball& BallChain::operator[](const uint& index) const {
+	if (index < before_gap.size())
+		return before_gap[index];
+	return after_gap[after_gap.size() - 1 - (index - before_gap.size())];
+}
+
+Ball& BallChain::front() { return (*this)[0]; }
+Ball& BallChain::back() { return (*this)[size() - 1]; }
+
+void BallChain::insert(const uint& index, Ball ball) {
+	move_gap(index);
+	before_gap.push_back(move(ball));
+}
+
+void BallChain::push_back(Ball ball) { insert(size(), move(ball)); }
+
+void BallChain::erase(const uint& index, const uint& count) {
+	// the erased balls are the last ones after the gap
+	move_gap(index);
+	after_gap.erase(after_gap.end() - count, after_gap.end());
+}
+
+BallChain BallChain::split(const uint& index) {
+	move_gap(index);
+
+	// every ball after the gap goes to the new chain, which has it's gap at the start
+	BallChain result;
+	swap(result.after_gap, after_gap);
+	return result;
+}
+
+void BallChain::join(BallChain& other) {
+	// with this chain's gap at it's end and the other's at it's start,
+	// the other's balls become this chain's balls after the gap
+	move_gap(size());
+	other.move_gap(0);
+	swap(after_gap, other.after_gap);
 }
 
 uint BallSegment::get_total_length() const {
 	return Ball::BALL_SIZE * static_cast<uint>(balls.size());
 }
 
+void BallSegment::mark_dirty(const uint& start, const uint& end) {
+	if (start >= end)
+		return;
+
+	if (is_dirty()) {
+		dirty_start = min(dirty_start, start);
+		dirty_end = max(dirty_end, end);
+	}
+	else {
+		dirty_start = start;
+		dirty_end = end;
+	}
+}
+
+bool BallSegment::is_dirty() const { return dirty_start < dirty_end; }
+
 void BallSegment::shift() {
 	is_shifting = true;
 
@@ -90,137 +175,117 @@ void BallSegment::shift() {
 	shift_timer->reset(true);
 }
 
-BTCreationException::BTCreationException(const char* message) { msg = message; }
-const char* BTCreationException::what() { return msg; }
+void BallParticles::emit(ParticlePool& pool, const vec2& origin, BallColor color) {
+	SDL_Color particle_color = BALLCOLOR_TO_RGB_MAP.at(color);
+	particle_color.a = 255;
 
-BallTrack::BallTrack(
-	const vector<vec2>& points, 
-	const uint& ball_count, 
-	shared_ptr<AssetManager> asset_manager, 
-	shared_ptr<EntityManager> entity_manager
-) : asset_manager(asset_manager), entity_manager(entity_manager) {
-	// save the given points for later use
-	cache.points = points;
-	// if there aren't enough points to construct a track, throw an error
-	if (points.size() < 2) {
-		throw new BTCreationException("track point count is less than 2");
-	}
-	// construct track segments for each point pair
-	for (int i = 1; i < points.size(); i++) {
-		const vec2& point2 = points[i];
-		const vec2& point1 = points[i - 1];
-		TrackSegment segment;
-		// using Pythagoras theorem to find the length, angle and cosine/sine of the angle of the segment
-		float w = point2.x - point1.x;
-		float h = point2.y - point1.y;
-		segment.length = hypotf(w, h);
-		segment.angle_cos = w / segment.length;
-		segment.angle_sin = h / segment.length;
-		segment.angle = acosf(segment.angle_cos);
-
-		// as cmath's acos doesn't give negative values, we need to account for negative angles
-		if (segment.angle_cos < 0)
-			segment.angle -= static_cast<float>(M_PI);
-
-		// if the height of the segment's right triangle is negative
-		// (the segment's end point is closer to the top boundary than the start point),
-		// the angle needs to be sign-inverted
-		if (h < 0) { 
-			segment.angle *= -1;
-		}
-		// if the width of the segment's right triangle is negative
-		// (the segment's end point is closer to the left boundary than the start point),
-		// the angle needs to be mirrored along the center point (add 180deg)
-		if (w < 0) {
-			segment.angle += static_cast<float>(M_PI);
-		}
-		// convert given angle to standard normalized degree form
-		segment.angle = normalize_angle(rad_to_deg(segment.angle));
+	uint particle_count = rand() % (MAX_COUNT - MIN_COUNT) + MIN_COUNT;
+	for (uint i = 0; i < particle_count; i++) {
+		vec2 position = origin;
 
-		cache.segments.push_back(segment);
-	}
+		float random_pos_angle = static_cast<float>(rand_float() * M_PI * 2);
+		float random_pos_len = static_cast<float>(rand_float() * static_cast<float>(Ball::BALL_SIZE) / 2);
+		position.x += cosf(random_pos_angle) * random_pos_len;
+		position.y += sinf(random_pos_angle) * random_pos_len;
+
+		vec2 velocity;
+		velocity.x = (rand_float() * (MAX_VELOCITY - MIN_VELOCITY) + MIN_VELOCITY) * (rand() % 2 == 1 ? -1 : 1);
+		velocity.y = (rand_float() * (MAX_VELOCITY - MIN_VELOCITY) + MIN_VELOCITY) * (rand() % 2 == 1 ? -1 : 1);
 
-	// calculating and caching the total length of the track
-	cache.total_length = 0.0F;
-	for (TrackSegment segment : cache.segments) {
-		cache.total_length += segment.length;
+		// if the pool is full, the rest of the particles are dropped
+		if (!pool.emit(position, velocity, particle_color))
+			return;
 	}
+}
 
+void BallTransformBatch::clear() {
+	balls.clear();
+	track_positions.clear();
+	segment_indices.clear();
+}
+
+void BallTransformBatch::add(Ball* ball, const float& track_position, const uint& segment_index) {
+	balls.push_back(ball);
+	track_positions.push_back(track_position);
+	segment_indices.push_back(segment_index);
+}
+
+void BallTransformBatch::compute(const TrackArrays& track) {
+	uint count = static_cast<uint>(balls.size());
+	x.resize(count);
+	y.resize(count);
+	rotation.resize(count);
+
+	Kernels::get().ball_transforms(
+		track,
+		track_positions.data(), segment_indices.data(), count,
+		x.data(), y.data(), rotation.data()
+	);
+}
+
+BallTrack::BallTrack(
+	const BallTrackCache& track_cache, 
+	const uint& ball_count, 
+	shared_ptr<AssetManager> asset_manager
+) : asset_manager(asset_manager), cache(track_cache) {
 	BallSegment segment;
 	for (uint i = 0; i < ball_count; i++) {
 		BallColor color = (BallColor)(rand() % BALL_COLOR_COUNT);
 		segment.balls.push_back(
 			Ball(asset_manager, color)
 		);
+		count_balls(color, 1);
 	}
+	// the random colors can already form matches anywhere in the segment
+	segment.mark_dirty(0, static_cast<uint>(segment.balls.size()));
 	ball_segments.push_back(segment);
 
 	// shift back the created segment
 	ball_segments[0].position = -(static_cast<float>(ball_segments[0].get_total_length()));
 
-	// prepare the death hole sprite
-
-	vec2 dh_pos = cache.points[0];
-
-	for (const TrackSegment& ts : cache.segments) {
-		dh_pos.x += ts.length * ts.angle_cos;
-		dh_pos.y += ts.length * ts.angle_sin;
-	}
-
-	death_window = make_unique<Sprite>(&asset_manager->get_texture("death_window"), dh_pos, 0.25);
+	// prepare the death hole sprite at the end of the track
+	death_window = make_unique<Sprite>(&asset_manager->get_texture("death_window"), cache.end_position, 0.25);
 	death_window->horizontal_alignment = Center;
 	death_window->vertical_alignment = Middle;
 }
 
-optional<uint> BallTrack::get_track_segment_by_position(const float& position) const {
-	uint segment_index = 0;
-	// go through the track segments and add up the total length from the start
-	// until the given position is within the current total length, which means
-	// that the given position is in the last added segment
-	float current_length = cache.segments[0].length;
-	while (current_length < position) {
-		segment_index++;
-		// if we hit the end, return the last segment's index
-		if (segment_index >= cache.segments.size()) {
-			return nullopt;
-		}
+void BallTrack::set_track(const BallTrackCache& track_cache) {
+	cache = track_cache;
+	death_window->global_transform.position = cache.end_position;
+}
 
-		current_length += cache.segments[segment_index].length;
-	}
-	return segment_index;
-}
-
-vector<uint> BallTrack::get_track_segments_from_ball_segment(const BallSegment& ball_segment) const {
-	vector<uint> result;
-
-	// track segment index of the start of given ball segment
-	optional<uint> start_track_index = get_track_segment_by_position(ball_segment.position);
-	if (start_track_index == nullopt)
-		start_track_index = 0;
-	// track segment index of the end of given ball segment
-	optional<uint> end_track_index = get_track_segment_by_position(ball_segment.position + ball_segment.get_total_length());
-	if (end_track_index == nullopt)
-		end_track_index = static_cast<uint>(cache.segments.size() - 1);
-
-	// every track segment index between the start and end ones 
-	// will also contain the given ball_segment, so we add the resulting range
-	for (uint i = start_track_index.value(); i <= end_track_index.value(); i++)
-		result.push_back(i);
-	
-	return result;
+optional<uint> BallTrack::get_track_segment_by_position(const float& position) const {
+	return cache.find_segment(position);
 }
 
-float BallTrack::get_track_segment_length_sum(const uint& last_segment) const {
-	// if the given last segment index to sum to is more than there are segments, 
-	// return the total length, as there won't be any more segments than currently exist
-	if (last_segment >= cache.segments.size() - 1)
-		return cache.total_length;
+bool BallTrack::find_dirty_match(BallSegment& segment, uint& match_start, uint& match_count) const {
+	uint ball_count = static_cast<uint>(segment.balls.size());
+	segment.dirty_end = min(segment.dirty_end, ball_count);
+	if (!segment.is_dirty())
+		return false;
+
+	// start from the beginning of the run the first dirty ball is in...
+	uint run_start = segment.dirty_start;
+	while (run_start > 0 && segment.balls[run_start - 1].color == segment.balls[run_start].color)
+		run_start--;
+
+	// ... and go through the runs until the end of the dirty range
+	while (run_start < segment.dirty_end) {
+		uint run_end = run_start + 1;
+		while (run_end < ball_count && segment.balls[run_end].color == segment.balls[run_start].color)
+			run_end++;
+
+		if (run_end - run_start >= 3) {
+			match_start = run_start;
+			match_count = run_end - run_start;
+			return true;
+		}
 
-	float length = 0;
-	for (int i = 0; i <= static_cast<int>(last_segment); i++)
-		length += cache.segments[i].length;
+		run_start = run_end;
+	}
 
-	return length;
+	segment.dirty_start = segment.dirty_end = 0;
+	return false;
 }
 
 void BallTrack::draw(SDL_Renderer* renderer, const RendererState& renderer_state) const {
@@ -229,27 +294,30 @@ void BallTrack::draw(SDL_Renderer* renderer, const RendererState& renderer_state
 	// go through each ball segment
 	for (const BallSegment& segment : ball_segments)
 		// and each of the balls of the segments
-		for (const Ball& ball : segment.balls)
-			// and draw the ball
-			if (ball.show)
+		for (uint i = 0; i < segment.balls.size(); i++) {
+			const Ball& ball = segment.balls[i];
+			// and draw the ball, if it's shown and on the screen
+			if (cull_drawable(ball, renderer_state))
 				ball.draw(renderer, renderer_state);
+		}
+}
 
-	for (const BallParticles& bp : ball_particles)
-		bp.draw(renderer, renderer_state);
+void BallTrackEvents::clear() {
+	score = 0;
+	connect_count = 0;
+	break_count = 0;
+	broken_balls.clear();
 }
 
 void BallTrack::update(const float& delta, GameState& game_state) {
-	if (ball_segments.size() == 0) {
-		if (!is_failing && !is_fading_out_to_screen) {
-			is_fading_out_to_screen = true;
-			game_state.fade_in([&]() {
-				// delete Level to prepare for the next load
-				entity_manager->schedule_to_delete("level");
-				game_state.set_section(WinScreen);
-				game_state.fade_out([](){}, 1.0F);
-			}, 1.0F);
-		}
-	}
+	simulate(delta, game_state);
+	apply_events(game_state);
+}
+
+void BallTrack::simulate(const float& delta, GameState& game_state) {
+	events.clear();
+
+	position_balls(delta, game_state);
 
 	// go through each ball segment
 	for (int i = 0; i < ball_segments.size(); i++) {
@@ -259,82 +327,10 @@ void BallTrack::update(const float& delta, GameState& game_state) {
 			continue;
 		}
 
-		// and each of the balls of the segments
-		for (int i = 0; i < segment.balls.size(); i++) {
-			// calculate the current ball's position relative to the start of the track
-			float ball_absolute_position = segment.position + i * Ball::BALL_SIZE;
-			// find the track segment the ball is in
-			optional<uint> track_segment_index = get_track_segment_by_position(ball_absolute_position);
-			if (track_segment_index == nullopt) {
-				segment.balls[i].show = false;
-				continue;
-			}
-			else {
-				segment.balls[i].show = true;
-			}
-
-			// fade out balls that are close to the death window
-
-			float distance_to_end = cache.total_length - ball_absolute_position;
-			if (segment.balls[i].show && distance_to_end < Ball::BALL_SIZE * 3)
-				segment.balls[i].opacity = distance_to_end / (Ball::BALL_SIZE * 3);
-			else
-				segment.balls[i].opacity = 1;
-
-			const TrackSegment& track_segment = cache.segments[track_segment_index.value()];
-
-			// get the track's length up to the previous track segment...
-			float total_sum = 0;
-			if (track_segment_index.value() > 0)
-				total_sum = get_track_segment_length_sum(track_segment_index.value() - 1);
-
-			// ... to find the ball's position relative to the track segment it's in
-			float ball_segment_position = ball_absolute_position - total_sum;
-
-			Ball& ball = segment.balls[i];
-			// rotate the ball along it's Z axis to point (or roll) in the direction of the track segment
-			ball.global_transform.rotation = track_segment.angle + 90;
-			// rotate the ball along it's local X axis (basically roll the ball) by the length of
-			// the path it has rolled from the track's start
-			ball.set_ball_angle(ball_absolute_position);
-
-			vec2 previous_track_end_point = cache.points[track_segment_index.value()];
-
-			const float& angle_cos = track_segment.angle_cos;
-			const float& angle_sin = track_segment.angle_sin;
-
-			// set the current ball's position along the track by offsetting it by 
-			// the previous track end point position and adding it's "segment position" pointing
-			// in the direction of the segment
-			ball.global_transform.position.x = previous_track_end_point.x + angle_cos * ball_segment_position;
-			ball.global_transform.position.y = previous_track_end_point.y + angle_sin * ball_segment_position;
-
-			// and finally, update the ball after changing the ball angle
-			ball.update(delta, game_state);
-		}
-
-		if (is_failing) {
-			bool are_segments_left_on_screen = false;
-			for (BallSegment& seg : ball_segments) {
-				if (seg.position < cache.total_length) {
-					are_segments_left_on_screen = true;
-					break;
-				}
-			}
-			if (are_segments_left_on_screen)
-				speed_multiplier += FAIL_SEGMENT_ACCELERATION * delta;
-			else if (!is_fading_out_to_screen) {
-				is_fading_out_to_screen = true;
-
-				game_state.fade_in([&]() {
-					// delete Level to prepare for the next load
-					entity_manager->schedule_to_delete("level");
-
-					game_state.set_section(DeathScreen);
-					game_state.fade_out([]() {}, 1.0F);
-				}, 1.0F);
-			}
-		}
+		// while failing, the balls rush to the end of the track,
+		// the level ends once none are left on it (see BallTrackSet)
+		if (is_failing && has_balls_on_track())
+			speed_multiplier += FAIL_SEGMENT_ACCELERATION * delta;
 
 		if (segment.shift_timer) {
 			if (segment.shift_timer->is_done()) {
@@ -382,68 +378,54 @@ void BallTrack::update(const float& delta, GameState& game_state) {
 			// and the next segment is not shifting (i.e. a ball is being added into the segment) combine both ball segments into one
 			if (segment.position + segment.get_total_length() >= next_segment.position + SEGMENT_COLLISION_ERROR && !next_segment.is_shifting) {
 				connect_ball_segments(i);
-				SoundManager::play_sound(asset_manager->get_audio("ball_collision"));
+				events.connect_count++;
 			}
 		}
 
 		// check if we have three or more balls of the same color in a row
-		// and if so, break them
-
-		BallColor saved_color = segment.balls[0].color;
+		// around the balls that were added or joined, and if so, break them
+		// the balls after a broken string are cut off into the next segment, which is checked next
 		uint saved_ball_index = 0;
-		uint same_color_count = 1;
-		for (int i = 1; i < segment.balls.size(); i++) {
-			BallColor current_color = segment.balls[i].color;
-			if (saved_color == current_color)
-				same_color_count++;
-			else if (same_color_count >= 3)
-				break;
-			else {
-				saved_color = current_color;
-				saved_ball_index = i;
-				same_color_count = 1;
-			}
-		}
-
-		// if we found a string of 3 or more balls, break them
-		if (same_color_count >= 3) {
-			auto start_it = segment.balls.begin() + saved_ball_index;
-			auto end_it = segment.balls.begin() + saved_ball_index + same_color_count;
-
-			// add breaking particles
+		uint same_color_count = 0;
+		while (find_dirty_match(segment, saved_ball_index, same_color_count)) {
+			// keep the broken balls for their particles
 			for (uint i = saved_ball_index; i < saved_ball_index + same_color_count; i++) {
 				const Ball& ball = segment.balls[i];
-
-				ball_particles.push_back(
-					move(
-						BallParticles(
-							ball.global_transform.position, 
-							ball.color, 
-							&asset_manager->get_texture("ball_particle")
-						)
-					)
-				);
+				events.broken_balls.push_back({ ball.global_transform.position, ball.color });
 			}
 
-			game_state.game_score += same_color_count * SCORE_PER_BALL;
+			events.score += same_color_count * SCORE_PER_BALL;
+			count_balls(segment.balls[saved_ball_index].color, -static_cast<int>(same_color_count));
 
 			// delete the string of balls
-			segment.balls.erase(start_it, end_it);
-			
+			segment.balls.erase(saved_ball_index, same_color_count);
+
+			// the dirty balls after the string move back in place of it
+			auto shift_dirty_index = [&](uint& index) {
+				if (index >= saved_ball_index + same_color_count)
+					index -= same_color_count;
+				else if (index > saved_ball_index)
+					index = saved_ball_index;
+			};
+			shift_dirty_index(segment.dirty_start);
+			shift_dirty_index(segment.dirty_end);
+
+			events.break_count++;
+
 			// leave a blank space in place of them
 			// if the blank space is not at the start, cut the segment
-			if (saved_ball_index > 0)
+			if (saved_ball_index > 0) {
 				cut_ball_segment(i, static_cast<float>(saved_ball_index * Ball::BALL_SIZE), static_cast<float>(Ball::BALL_SIZE * same_color_count));
-			// otherwise, just shift it by broken ball count
-			else
-				segment.position += Ball::BALL_SIZE * same_color_count;
+				break;
+			}
 
-			// play a breaking sound
-			SoundManager::play_sound(asset_manager->get_audio("ball_break"));
+			// otherwise, just shift it by broken ball count
+			segment.position += Ball::BALL_SIZE * same_color_count;
 		}
 
 		// if some segment is out of the track length, we're dead
-		if (segment.position + segment.get_total_length() > cache.total_length) {
+		// (the segment is looked up again, as cutting it could have moved the segments)
+		if (ball_segments[i].position + ball_segments[i].get_total_length() > cache.total_length) {
 			is_failing = true;
 		}
 	}
@@ -457,75 +439,170 @@ void BallTrack::update(const float& delta, GameState& game_state) {
 		),
 		ball_segments.end()
 	);
+}
 
-	for (int i = 0; i < ball_particles.size(); i++) {
-		BallParticles& bp = ball_particles[i];
-		bp.update(delta, game_state);
+void BallTrack::apply_events(GameState& game_state) {
+	game_state.game_score += events.score;
 
-		if (bp.is_done())
-			ball_particles.erase(ball_particles.begin() + i);
+	for (uint i = 0; i < events.connect_count; i++)
+		SoundManager::play_sound(asset_manager->get_audio("ball_collision"));
+	for (uint i = 0; i < events.break_count; i++)
+		SoundManager::play_sound(asset_manager->get_audio("ball_break"));
+
+	// add breaking particles
+	if (particle_pool) {
+		for (const auto& [position, color] : events.broken_balls)
+			BallParticles::emit(*particle_pool, position, color);
 	}
 }
 
-optional<BallTrackCollisionData> BallTrack::get_collision_data(const vec2& point, const float& point_radius) const {
-	BallTrackCollisionData collision_data;
+bool BallTrack::has_failed() const { return is_failing; }
 
-	vec2* collision_point = nullptr;
-	// go through all the track segments...
-	for (int i = 0; i < cache.segments.size(); i++) {
-		const TrackSegment& segment = cache.segments[i];
-		vec2 start_point = cache.points[i];
-		vec2 end_point = cache.points[i + 1];
+void BallTrack::fail() { is_failing = true; }
 
-		// ... and find if the given point with radius (circle) is on the track's line
-		if (Collision::is_circle_on_line(start_point, end_point, point, point_radius)) {
-			// the collision point will be the nearest point on the line
-			vec2 p = Collision::get_closest_point_on_line(start_point, end_point, point);
-			collision_point = &p;
-			collision_data.track_segment_index = i;
-			collision_data.track_segment_position = vec2(start_point, *collision_point).len();
-			break;
-		}
+bool BallTrack::is_cleared() const { return ball_segments.empty(); }
+
+bool BallTrack::has_balls_on_track() const {
+	for (const BallSegment& segment : ball_segments) {
+		if (segment.position < cache.total_length)
+			return true;
 	}
+	return false;
+}
 
-	// if there was no collision with the track, then no collision happened at all
-	if (collision_point == nullptr)
-		return nullopt;
+void BallTrack::position_balls(const float& delta, GameState& game_state) {
+	transform_batch.clear();
 
-	// continue by going through all the ball segments... 
-	for (int i = 0; i < ball_segments.size(); i++) {
-		const BallSegment& ball_segment = ball_segments[i];
-		// ... and seeing if any of the ball segments match the track segment, 
-		// with which the given circle collided
-
-		// get all track segment indecies that the ball segment goes through
-		auto indecies = get_track_segments_from_ball_segment(ball_segment);
-		// if the track index that corresponds to the possible collision is in the array of
-		// indecies that the ball segment goes through, there could be a collision
-		if (find(indecies.begin(), indecies.end(), collision_data.track_segment_index) != indecies.end()) {
-			// get the collision position relative to the start of the track
-			float absolute_collision_position = 
-				get_track_segment_length_sum(collision_data.track_segment_index - 1) + collision_data.track_segment_position;
-
-			// get the collision position relative to the start of the ball segment
-			float ball_segment_collision_position = absolute_collision_position - ball_segment.position;
-			// if the relative collision position is within the ball_segment's length, a collision happened
-			if (
-				ball_segment_collision_position >= -(static_cast<float>(Ball::BALL_SIZE) / 2) && 
-				ball_segment_collision_position <= ball_segment.get_total_length() + (static_cast<float>(Ball::BALL_SIZE) / 2)
-			) {
-				collision_data.ball_segment_index = i;
-				collision_data.ball_segment_position = ball_segment_collision_position;
-
-				// return the constructed collision data early in the for-loop
-				return collision_data;
+	// go through each ball segment
+	for (BallSegment& segment : ball_segments) {
+		// the balls are in order along the track and move a little each frame,
+		// so their track segments are found in one sweep from the first ball's segment of the last frame
+		uint track_cursor = segment.track_cursor;
+
+		// and each of the balls of the segments
+		for (int i = 0; i < segment.balls.size(); i++) {
+			Ball& ball = segment.balls[i];
+
+			// calculate the current ball's position relative to the start of the track
+			float ball_absolute_position = segment.position + i * Ball::BALL_SIZE;
+			// find the track segment the ball is in
+			optional<uint> track_segment_index = cache.find_segment_from(track_cursor, ball_absolute_position);
+			if (i == 0)
+				segment.track_cursor = track_cursor;
+			if (track_segment_index == nullopt) {
+				ball.show = false;
+				continue;
 			}
+			ball.show = true;
+
+			// fade out balls that are close to the death window
+
+			float distance_to_end = cache.total_length - ball_absolute_position;
+			if (distance_to_end < Ball::BALL_SIZE * 3)
+				ball.opacity = distance_to_end / (Ball::BALL_SIZE * 3);
+			else
+				ball.opacity = 1;
+
+			// rotate the ball along it's local X axis (basically roll the ball) by the length of
+			// the path it has rolled from the track's start
+			ball.set_ball_angle(ball_absolute_position);
+
+			transform_batch.add(&ball, ball_absolute_position, track_segment_index.value());
 		}
-		// otherwise there was no collision, check the next ball segment
 	}
-	
-	// if we're here, the for-loop didn't return early, so no collision happened
-	return nullopt;
+
+	// set the balls' positions along the track by offsetting them by their track segment's
+	// start point and adding their "segment position" pointing in the direction of the segment,
+	// and rotate them along their Z axis to point (or roll) in the direction of the track segment
+	transform_batch.compute(cache.arrays);
+
+	for (uint i = 0; i < transform_batch.balls.size(); i++) {
+		Ball& ball = *transform_batch.balls[i];
+		ball.global_transform.position.x = transform_batch.x[i];
+		ball.global_transform.position.y = transform_batch.y[i];
+		ball.global_transform.rotation = transform_batch.rotation[i];
+
+		// and finally, update the ball after changing the ball angle
+		ball.update(delta, game_state);
+	}
+}
+
+optional<BallTrackCollisionData> BallTrack::get_swept_collision_data(const vec2& start, const vec2& end, const float& point_radius) const {
+	optional<BallTrackCollisionData> earliest_collision;
+
+	// the moving circle touches a track segment within twice it's radius, so the grid is
+	// searched around the middle of the movement, as far as it goes plus that distance
+	float reach = point_radius * 2;
+	vec2 movement(start, end);
+	vec2 middle = start + movement / 2;
+	float search_reach = fmaxf(fabsf(movement.x), fabsf(movement.y)) / 2 + reach;
+
+	cache.grid.for_each_near(middle, search_reach, [&](uint i) {
+		const vec2& start_point = cache.points[i];
+		const vec2& end_point = cache.points[i + 1];
+
+		float enter, exit;
+		if (!Collision::get_swept_point_on_line_interval(start_point, end_point, start, end, reach, enter, exit))
+			return;
+		if (earliest_collision.has_value() && enter >= earliest_collision->time_of_impact)
+			return;
+
+		// while the circle is near the segment, the collision point (nearest point on the segment)
+		// moves linearly along it and stops at it's ends
+		float segment_length = cache.segments[i].length;
+		vec2 along = segment_length > 0 ? vec2(start_point, end_point) / segment_length : vec2(0, 0);
+		float along_start = vec2::dot(vec2(start_point, start), along);
+		float along_step = vec2::dot(movement, along);
+		float segment_start = cache.arrays.start_length[i];
+
+		for (uint j = 0; j < ball_segments.size(); j++) {
+			const BallSegment& ball_segment = ball_segments[j];
+
+			// the part of this track segment the ball segment covers, with half a ball of margin on each end
+			float covered_start = ball_segment.position - static_cast<float>(Ball::BALL_SIZE) / 2 - segment_start;
+			float covered_end = ball_segment.position + ball_segment.get_total_length() + static_cast<float>(Ball::BALL_SIZE) / 2 - segment_start;
+			if (covered_end < 0 || covered_start > segment_length)
+				continue;
+
+			// a covered part reaching past an end of the segment includes every position clamped to it
+			float min_position = covered_start <= 0 ? -INFINITY : covered_start;
+			float max_position = covered_end >= segment_length ? INFINITY : covered_end;
+
+			// find the earliest fraction within the interval at which the collision point is covered
+			float hit_start = enter;
+			float hit_end = exit;
+			if (along_step == 0) {
+				if (along_start < min_position || along_start > max_position)
+					continue;
+			}
+			else {
+				float first = (min_position - along_start) / along_step;
+				float second = (max_position - along_start) / along_step;
+				if (first > second)
+					swap(first, second);
+
+				hit_start = fmaxf(hit_start, first);
+				hit_end = fminf(hit_end, second);
+				if (hit_start > hit_end)
+					continue;
+			}
+
+			if (earliest_collision.has_value() && hit_start >= earliest_collision->time_of_impact)
+				continue;
+
+			float track_segment_position = clamp(along_start + along_step * hit_start, 0.0F, segment_length);
+
+			BallTrackCollisionData collision_data;
+			collision_data.track_segment_index = i;
+			collision_data.ball_segment_index = j;
+			collision_data.track_segment_position = track_segment_position;
+			collision_data.ball_segment_position = segment_start + track_segment_position - ball_segment.position;
+			collision_data.time_of_impact = hit_start;
+			earliest_collision = collision_data;
+		}
+	});
+
+	return earliest_collision;
 }
 
 bool BallTrack::cut_ball_segment(const uint& ball_segment_index, const float& position, const float& spacing) {
@@ -539,19 +616,18 @@ bool BallTrack::cut_ball_segment(const uint& ball_segment_index, const float& po
 	BallSegment& first_ball_segment = ball_segments[ball_segment_index];
 	BallSegment& second_ball_segment = ball_segments[ball_segment_index + 1];
 
-	// cut off balls before the hit one and add them to the new segment
-	for (int i = last_ball_index; i < first_ball_segment.balls.size(); i++) {
-		second_ball_segment.balls.push_back(first_ball_segment.balls[i]);
-	}
-
-	// cut off balls after the hit one
-	first_ball_segment.balls.erase(first_ball_segment.balls.begin() + last_ball_index, first_ball_segment.balls.end() - 1);
+	// move the balls from the hit one on to the new segment
+	second_ball_segment.balls = first_ball_segment.balls.split(last_ball_index);
 
-	// remove one mystereously added ball at the end after the erase
-	first_ball_segment.balls.pop_back();
+	// split the dirty range between both segments
+	if (first_ball_segment.dirty_end > last_ball_index)
+		second_ball_segment.mark_dirty(max(first_ball_segment.dirty_start, last_ball_index) - last_ball_index, first_ball_segment.dirty_end - last_ball_index);
+	first_ball_segment.dirty_end = min(first_ball_segment.dirty_end, last_ball_index);
 
 	// calculate the position of the newly added ball_segment
 	second_ball_segment.position = first_ball_segment.position + first_ball_segment.get_total_length() + spacing;
+	// the new segment's balls were just found from the first segment's cursor
+	second_ball_segment.track_cursor = first_ball_segment.track_cursor;
 
 	return true;
 }
@@ -576,12 +652,17 @@ void BallTrack::connect_ball_segments(const uint& ball_segment_index, bool inher
 	if (inherit_seconds_speed)
 		first_ball_segment.speed = second_ball_segment.speed;
 
+	// the balls on both sides of the joint are new neighbours, and the second segment's dirty balls
+	// keep being dirty after the first segment's balls
+	uint first_ball_count = static_cast<uint>(first_ball_segment.balls.size());
+	uint second_ball_count = static_cast<uint>(second_ball_segment.balls.size());
+	if (second_ball_segment.is_dirty())
+		first_ball_segment.mark_dirty(second_ball_segment.dirty_start + first_ball_count, second_ball_segment.dirty_end + first_ball_count);
+	if (first_ball_count > 0 && second_ball_count > 0)
+		first_ball_segment.mark_dirty(first_ball_count - 1, first_ball_count + 1);
+
 	// move all balls from the second segment to the end of the first one
-	first_ball_segment.balls.insert(
-		first_ball_segment.balls.end(),
-		make_move_iterator(second_ball_segment.balls.begin()),
-		make_move_iterator(second_ball_segment.balls.end())
-	);
+	first_ball_segment.balls.join(second_ball_segment.balls);
 
 	ball_segments.erase(ball_segments.begin() + ball_segment_index + 1);
 }
@@ -602,67 +683,47 @@ const TrackSegment& BallTrack::get_track_segment_by_bs_index(const float& ball_s
 vec2 BallTrack::get_insertion_pos_by_bs_index(const float& ball_segment_index, bool inserting_at_end) const {
 	auto& ball_segment = ball_segments[static_cast<uint>(ball_segment_index)];
 
-	// calculate the ball's position relative to the start of the track
+	// calculate the ball's position relative to the start of the track,
+	// a ball inserted at the end goes right before the segment's first ball
 	float ball_absolute_position = ball_segment.position;
-	if (!inserting_at_end)
+	if (inserting_at_end)
+		ball_absolute_position -= Ball::BALL_SIZE;
+	else
 		ball_absolute_position += ball_segment.get_total_length();
 
-	// find the track segment the ball is in
-	optional<uint> track_segment_index = get_track_segment_by_position(ball_absolute_position);
-	if (track_segment_index == nullopt)
-		track_segment_index = static_cast<uint>(cache.segments.size() - 1);
-
-	const TrackSegment& track_segment = cache.segments[track_segment_index.value()];
-
-	// get the track's length up to the previous track segment...
-	float total_sum = 0;
-	if (track_segment_index.value() > 0)
-		total_sum = get_track_segment_length_sum(track_segment_index.value() - 1);
-
-	// ... to find the ball's position relative to the track segment it's in
-	float ball_segment_position = ball_absolute_position - total_sum;
-
-	vec2 result = cache.points[0];
-
-	// sum up global position for all track segments up to the previous one
-	for (uint i = 0; i < track_segment_index.value(); i++) {
-		const TrackSegment& current_track_segment = cache.segments[i];
-		result.x += current_track_segment.length * current_track_segment.angle_cos;
-		result.y += current_track_segment.length * current_track_segment.angle_sin;
-	}
-
-	// add the final track segment positoin
-	result.x += ball_segment_position * track_segment.angle_cos;
-	result.y += ball_segment_position * track_segment.angle_sin;
-
-	if (inserting_at_end) {
-		result.x -= Ball::BALL_SIZE * track_segment.angle_cos;
-		result.y -= Ball::BALL_SIZE * track_segment.angle_sin;
-	}
-
-	return result;
+	return cache.position_at(ball_absolute_position);
 }
 
 void BallTrack::insert_new_ball(const uint& ball_segment_index, BallColor color, bool inserting_at_end) {
 	BallSegment& segment = ball_segments[ball_segment_index];
 
 	Ball new_ball(asset_manager, color);
+	count_balls(color, 1);
 
 	if (inserting_at_end) {
-		segment.balls.insert(segment.balls.begin(), new_ball);
+		segment.balls.insert(0, move(new_ball));
 		segment.position -= Ball::BALL_SIZE;
-	}
-	else
-		segment.balls.push_back(new_ball);
-}
 
-vector<BallColor> BallTrack::get_current_colors() const {
-	vector<BallColor> result;
-	for (const auto& segment : ball_segments) {
-		for (const auto& ball : segment.balls) {
-			if (find(result.begin(), result.end(), ball.color) == result.end())
-				result.push_back(ball.color);
+		// the dirty balls moved by one
+		if (segment.is_dirty()) {
+			segment.dirty_start++;
+			segment.dirty_end++;
 		}
+		segment.mark_dirty(0, 1);
 	}
-	return result;
+	else {
+		segment.balls.push_back(move(new_ball));
+		segment.mark_dirty(static_cast<uint>(segment.balls.size() - 1), static_cast<uint>(segment.balls.size()));
+	}
+}
+
+void BallTrack::count_balls(const BallColor& color, const int& change) {
+	color_counts[color] += change;
+
+	if (color_counts[color] > 0)
+		current_colors |= 1U << color;
+	else
+		current_colors &= ~(1U << color);
 }
+
+const BallColorMask& BallTrack::get_current_colors() const { return current_colors; }
@@ -9,7 +9,12 @@
 #include "../engine/AssetManager.h"
 #include "../engine/EntityManager.h"
 #include "../engine/SoundManager.h"
+#include "../engine/ParticlePool.h"
+#include "../engine/Kernels.h"
+#include "BallTrackCache.h"
 #include <random>
+#include <array>
+#include <bit>
 
 enum BallColor {
 	Red,
@@ -32,23 +37,58 @@ static const std::unordered_map<BallColor, std::string> BALL_COLOR_TEXTURE_MAP =
 	{ BallColor::Purple,	"ball_purple" }
 };
 
+// texture name of the neutral spritesheet, used for all colors when balls are tinted
+static const std::string BALL_TINTED_SHEET_TEXTURE = "ball_tinted";
+
+// ball color to RGB correspondence, used for tinting balls and particles
+static const std::unordered_map<BallColor, SDL_Color> BALLCOLOR_TO_RGB_MAP = {
+	{ BallColor::Red,		SDL_Color({ 255, 0, 0 }) },
+	{ BallColor::Green,	SDL_Color({ 0, 255, 0 }) },
+	{ BallColor::Blue,		SDL_Color({ 0, 0, 255 }) },
+	{ BallColor::Yellow,	SDL_Color({ 255, 255, 0 }) },
+	{ BallColor::Gray,		SDL_Color({ 255, 255, 255 }) },
+	{ BallColor::Purple,	SDL_Color({ 255, 0, 255 }) }
+};
+
 inline BallColor get_random_ball_color() {
 	return (BallColor)(rand() % BALL_COLOR_COUNT);
 }
 
+// set of ball colors, a bit per color
+typedef uint BallColorMask;
+
+// picks a random color of the given set, or any color if the set is empty
+inline BallColor pick_random_ball_color(const BallColorMask& colors) {
+	if (colors == 0)
+		return get_random_ball_color();
+
+	// clear the lowest bits until the picked one is the lowest
+	BallColorMask remaining_colors = colors;
+	int picked_index = rand() % popcount(colors);
+	for (int i = 0; i < picked_index; i++)
+		remaining_colors &= remaining_colors - 1;
+
+	return (BallColor)countr_zero(remaining_colors);
+}
+
 // the logic behind the ball that can rotate and spin with animation
 class Ball : public Sprite, public Updatable {
-	static const uint BALL_ROTATION_FRAME_COUNT = 100;	// frame count of the ball's spritesheet
-	static const uint BALL_SPRITESHEET_H = 10;			// ball count of the spritesheet's column
 	float ball_angle;	// ball rotation around it's X axis
 	shared_ptr<Sprite> sheen_sprite = nullptr;
 
 public:
+	static const uint BALL_ROTATION_FRAME_COUNT = 100;	// frame count of the ball's spritesheet
+	static const uint BALL_SPRITESHEET_H = 10;			// ball count of the spritesheet's column
+
 	shared_ptr<AssetManager> asset_manager = nullptr;
 	static const uint BALL_SIZE = 50; // physical ball size
 	BallColor color;
 	bool show = true;
 
+	// if set, all balls use the BALL_TINTED_SHEET_TEXTURE and get
+	// their color from BALLCOLOR_TO_RGB_MAP instead of a per-color spritesheet
+	static bool use_tinted_sheet;
+
 	Ball(
 		shared_ptr<AssetManager> asset_manager, // used for importing the specific ball textures
 		BallColor color,
@@ -56,6 +96,7 @@ public:
 	);
 
 	void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const override;
+	bool is_visible() const override;
 
 	void update(const float& delta, GameState& game_state) override;
 
@@ -66,140 +107,112 @@ public:
 
 	// change color to given one and replace the used texture
 	void change_color(BallColor new_color);
+
+	// gets the spritesheet used for the given color
+	static Texture& get_color_texture(AssetManager& asset_manager, BallColor color);
 };
 
-struct TrackSegment {
-	float angle = 0;
-	float angle_cos = 0;
-	float angle_sin = 0;
-	float length = 0;
+// buffers for computing transforms of all shown balls in one batch,
+// kept between frames to reuse their memory
+struct BallTransformBatch {
+	vector<Ball*> balls;
+	vector<float> track_positions;
+	vector<uint> segment_indices;
+	vector<float> x;
+	vector<float> y;
+	vector<float> rotation;
+
+	void clear();
+	void add(Ball* ball, const float& track_position, const uint& segment_index);
+	// runs the ball transforms kernel over all added balls
+	void compute(const TrackArrays& track);
 };
 
-// cache for precomputed values to quickly draw the ball track
-struct BallTrackCache {
-	vector<vec2> points;
-	vector<TrackSegment> segments;
-	float total_length = 0;
+// balls of a segment stored as a gap buffer: the balls before the gap are in order
+// and the balls after it are reversed, so inserting, erasing and splitting at the gap only
+// moves the affected balls, and moving the gap moves only the balls it passes
+//
+// balls are added, broken and cut near the same spot, so the gap rarely has to go far
+class BallChain {
+	vector<Ball> before_gap;
+	// reversed, the ball right after the gap is the last one
+	vector<Ball> after_gap;
+
+	void move_gap(const uint& index);
+
+public:
+	uint size() const;
+
+	Ball& operator[](const uint& index);
+	const Ball& operator[](const uint& index) const;
+	Ball& front();
+	Ball& back();
+
+	// inserts a ball before the one at given index
+	void insert(const uint& index, Ball ball);
+	void push_back(Ball ball);
+	// removes count balls starting at given index
+	void erase(const uint& index, const uint& count);
+
+	// removes the balls from given index to the end and returns them
+	BallChain split(const uint& index);
+	// moves all balls of the other chain to the end of this one
+	void join(BallChain& other);
 };
 
 struct BallSegment {
 	Timer* shift_timer = nullptr;
 
-	vector<Ball> balls;
+	BallChain balls;
 	float position = 0;
 	float speed = 0;
 	bool is_shifting = false;
+	// track segment of the first ball as of the last frame, the lookups of the balls start from it
+	uint track_cursor = 0;
+	// range of ball indices (end excluded) where balls were added or joined since the last update,
+	// only the runs of the same color going through it are checked for matches
+	uint dirty_start = 0;
+	uint dirty_end = 0;
 
 	void shift();
 
+	// adds the ball indices from start to end (excluded) to the dirty range
+	void mark_dirty(const uint& start, const uint& end);
+	bool is_dirty() const;
+
 	uint get_total_length() const;
 };
 
-// collision data for use with the BallTrack::get_collision_data function
+// collision data for use with the BallTrack::get_swept_collision_data function
 struct BallTrackCollisionData {
 	uint track_segment_index;
 	uint ball_segment_index;
 	float track_segment_position;
 	float ball_segment_position;
+	// fraction of the movement at which the collision happened
+	float time_of_impact = 0;
 };
 
-// exception thrown upon construction of BallTrack (i.e. there are less than 2 points for the track)
-class BTCreationException : public exception {
-	const char* msg;
-public:
-	BTCreationException(const char* message);
-	const char* what();
-};
-
-static const std::unordered_map<BallColor, SDL_Color> BALLCOLOR_TO_RGB_MAP = {
-	{ BallColor::Red,		SDL_Color({ 255, 0, 0 }) },
-	{ BallColor::Green,	SDL_Color({ 0, 255, 0 }) },
-	{ BallColor::Blue,		SDL_Color({ 0, 0, 255 }) },
-	{ BallColor::Yellow,	SDL_Color({ 255, 255, 0 }) },
-	{ BallColor::Gray,		SDL_Color({ 255, 255, 255 }) },
-	{ BallColor::Purple,	SDL_Color({ 255, 0, 255 }) }
-};
-
-class BallParticles : public Drawable, public Updatable {
+// emits the particles of a broken ball into a ParticlePool
+struct BallParticles {
 	static const uint MIN_COUNT = 10;
 	static const uint MAX_COUNT = 20;
 	static constexpr float MIN_VELOCITY = 10.0F;
 	static constexpr float MAX_VELOCITY = 200.0F;
-	static constexpr float SIZE = 10.0F;
-	static constexpr float GRAVITY = 100.0F;
-
-	struct Particle {
-		vec2 position;
-		vec2 velocity;
-	};
-	vector<Particle> particles;
-	SDL_Color color;
-	Texture* texture;
 
-	void create_particle(vec2 origin) {
-		Particle p;
-
-		p.position = origin;
-		
-		float random_pos_angle = static_cast<float>(rand_float() * M_PI * 2);
-		float random_pos_len = static_cast<float>(rand_float() * static_cast<float>(Ball::BALL_SIZE) / 2);
-		p.position.x += cosf(random_pos_angle) * random_pos_len;
-		p.position.y += sinf(random_pos_angle) * random_pos_len;
-
-		p.velocity.x = (rand_float() * (MAX_VELOCITY - MIN_VELOCITY) + MIN_VELOCITY) * (rand() % 2 == 1 ? -1 : 1);
-		p.velocity.y = (rand_float() * (MAX_VELOCITY - MIN_VELOCITY) + MIN_VELOCITY) * (rand() % 2 == 1 ? -1 : 1);
+	static void emit(ParticlePool& pool, const vec2& origin, BallColor color);
+};
 
-		particles.push_back(p);
-	}
+// effects of BallTrack::simulate on the rest of the game, which are applied
+// on the main thread by BallTrack::apply_events
+struct BallTrackEvents {
+	uint score = 0;
+	uint connect_count = 0;
+	uint break_count = 0;
+	// positions and colors of the broken balls for their particles
+	vector<pair<vec2, BallColor>> broken_balls;
 
-public:
-	BallParticles(
-		vec2 origin,
-		BallColor color,
-		Texture* particle_texture
-	) :
-		color(BALLCOLOR_TO_RGB_MAP.at(color)),
-		texture(particle_texture) 
-	{
-		for (uint i = 0; i < (rand() % (MAX_COUNT - MIN_COUNT) + MIN_COUNT); i++)
-			create_particle(origin);
-	}
-
-	void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const override {
-		for (const auto& p : particles) {
-			auto rect = texture->get_rect(p.position.x - SIZE / 2, p.position.y - SIZE / 2);
-			rect.w = SIZE;
-			rect.h = SIZE;
-
-			rect.x *= renderer_state.scaling;
-			rect.y *= renderer_state.scaling;
-			rect.w *= renderer_state.scaling;
-			rect.h *= renderer_state.scaling;
-			SDL_SetTextureColorMod(texture->get_raw(), color.r, color.g, color.b);
-
-			SDL_RenderCopyExF(renderer, texture->get_raw(), nullptr, &rect, 0, nullptr, SDL_FLIP_NONE);
-
-			SDL_SetTextureColorMod(texture->get_raw(), 255, 255, 255);
-		}
-	}
-
-	void update(const float& delta, GameState& game_state) {
-		for (int i = 0; i < particles.size(); i++) {
-			Particle& p = particles[i];
-
-			p.position.x += p.velocity.x * delta;
-			p.position.y += p.velocity.y * delta;
-
-			if (p.position.x > WINDOW_WIDTH + SIZE || p.position.x < -SIZE || p.position.y > WINDOW_HEIGHT + SIZE) {
-				particles.erase(particles.begin() + i);
-			}
-			else {
-				p.velocity.y += GRAVITY * delta;
-			}
-		}
-	}
-
-	bool is_done() const { return particles.size() == 0; }
+	void clear();
 };
 
 // logic behind drawing the balls on a track and checking collision with segments of balls
@@ -210,28 +223,37 @@ class BallTrack : public Drawable, public Updatable {
 	static constexpr float FAIL_SEGMENT_ACCELERATION = 50.0F;
 	static const uint SCORE_PER_BALL = 50;
 
-	// if some ball hits the death window, this is set to true...
+	// if some ball hits the death window, this is set to true
 	bool is_failing = false;
-	// ... and this is set to true when all the balls are gone
-	bool is_fading_out_to_screen = false;
 
 	// pointer to AssetManager for Ball's constructor
 	shared_ptr<AssetManager> asset_manager;
-	// pointer to EntityManager for Level finish
-	shared_ptr<EntityManager> entity_manager;
 
-	// ball breaking particles
-	vector<BallParticles> ball_particles;
+	// effects of the last simulate on the rest of the game
+	BallTrackEvents events;
+
 
 	unique_ptr<Sprite> death_window = nullptr;
 
+	BallTransformBatch transform_batch;
+
+	// number of balls of each color on the track and the set of colors with any balls,
+	// updated as balls are added and broken
+	array<uint, BALL_COLOR_COUNT> color_counts = {};
+	BallColorMask current_colors = 0;
+
+	// adds the change to the count of balls of the color
+	void count_balls(const BallColor& color, const int& change);
+
+	// sets the position, rotation and visibility of every ball by it's segment's position
+	void position_balls(const float& delta, GameState& game_state);
+
 	// find track segment's index by a given ball segment's position
 	optional<uint> get_track_segment_by_position(const float& position) const;
-	// get all track segment indecies that a given BallSegment goes through
-	vector<uint> get_track_segments_from_ball_segment(const BallSegment& ball_segment) const;
-	// calculate total track length up to (and including) the segment, 
-	// index of which is given as an argument
-	float get_track_segment_length_sum(const uint& last_segment) const;
+
+	// finds the first run of 3 or more balls of the same color going through the segment's dirty range,
+	// the range is cleared if there's none
+	bool find_dirty_match(BallSegment& segment, uint& match_start, uint& match_count) const;
 
 public:
 	static constexpr float BALL_INSERTION_TIME = 0.25F;
@@ -243,14 +265,37 @@ public:
 
 	float speed_multiplier = 1;
 
-	BallTrack(const vector<vec2>& points, const uint& ball_count, shared_ptr<AssetManager> asset_manager, shared_ptr<EntityManager> entity_manager);
+	// pool for ball breaking particles, shared with the level
+	shared_ptr<ParticlePool> particle_pool = nullptr;
+
+	BallTrack(const BallTrackCache& track_cache, const uint& ball_count, shared_ptr<AssetManager> asset_manager);
 	void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const override;
+	// simulates the track and applies it's events right away
 	void update(const float& delta, GameState& game_state) override;
 
-	// check for collision with the ball track at a given point 
-	// and radius of collision (ball's and/or track's radius)
+	// moves, connects and breaks the ball segments, changing nothing but this track,
+	// so that several tracks can be simulated at the same time.
+	// the game state isn't changed, the score, sounds and particles are kept for apply_events
+	void simulate(const float& delta, GameState& game_state);
+	// applies the events of the last simulate to the game, has to be called on the main thread
+	void apply_events(GameState& game_state);
+
+	// returns true if a ball reached the death window
+	bool has_failed() const;
+	// makes all balls rush to the death window, as when a ball reaches it
+	void fail();
+	// returns true if all the balls were broken
+	bool is_cleared() const;
+	// returns true if any ball segment hasn't reached the end of the track yet
+	bool has_balls_on_track() const;
+
+	// replaces the track, when it's level is reloaded, the balls keep their positions along the track
+	void set_track(const BallTrackCache& track_cache);
+
+	// check for the earliest collision of a circle moving from start to end, so that fast or
+	// slowly updated circles can't pass through the balls between two positions
 	// returns nullopt if there was no collision
-	optional<BallTrackCollisionData> get_collision_data(const vec2& point, const float& point_radius) const;
+	optional<BallTrackCollisionData> get_swept_collision_data(const vec2& start, const vec2& end, const float& point_radius) const;
 
 	// splits a ball segment into two parts by it's index and position
 	// and returns true if the segment was cut and false otherwise
@@ -275,6 +320,6 @@ public:
 	// needed for ball insertion animation
 	vec2 get_insertion_pos_by_bs_index(const float& ball_segment_index, bool inserting_at_end) const;
 
-	// gets the color spectrum of all balls currently shown
-	vector<BallColor> get_current_colors() const;
+	// gets the set of colors of all balls currently on the track
+	const BallColorMask& get_current_colors() const;
 };
@@ -4,6 +4,10 @@
 #include "../engine/SoundManager.h"
 #include <map>
 #include <functional>
+#include <string>
+#include <algorithm>
+
+using namespace std;
 
 struct MouseState {
 	vec2 previous_mouse_pos = vec2();
@@ -40,8 +44,24 @@ struct KeyboardState {
 struct RendererState {
 	float saved_scaling = 1;
 	vec2 window_size = vec2(1280, 720);
+	// window size relative to the logical resolution, the frame is scaled by it on present
 	float scaling = 1;
+	// offset of the presented frame inside the window, if it's letterboxed
+	vec2 present_offset = vec2();
 	bool is_fullscreen = false;
+
+	// scale the frame only by whole numbers to keep pixels sharp
+	bool integer_scaling = false;
+	// the frame is drawn at this multiple of the logical resolution and downscaled on present
+	int supersampling = 1;
+	// name of the SDL render driver to use, SDL chooses the driver if it's empty,
+	// applied on the next launch
+	string render_driver;
+
+	// counts of drawables drawn and skipped in the current frame,
+	// the renderer state is const while drawing, so they are mutable
+	mutable uint drawn_count = 0;
+	mutable uint culled_count = 0;
 };
 
 enum GameSection {
@@ -105,6 +125,11 @@ public:
 
 		free(scaling);
 
+		// write render driver name, prefixed with it's length
+		unsigned char render_driver_length = static_cast<unsigned char>(min<size_t>(renderer_state.render_driver.size(), 0xFF));
+		SDL_RWwrite(io, &render_driver_length, 1, 1);
+		SDL_RWwrite(io, renderer_state.render_driver.data(), render_driver_length, 1);
+
 		SDL_RWclose(io);
 	}
 
@@ -132,6 +157,13 @@ public:
 
 		free(scaling);
 
+		// settings saved by older versions end here, the read length stays 0 then
+		unsigned char render_driver_length = 0;
+		SDL_RWread(io, &render_driver_length, 1, 1);
+		renderer_state.render_driver.resize(render_driver_length);
+		if (render_driver_length > 0 && SDL_RWread(io, renderer_state.render_driver.data(), render_driver_length, 1) != 1)
+			renderer_state.render_driver.clear();
+
 		SDL_RWclose(io);
 	}
 };
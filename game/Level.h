@@ -3,6 +3,7 @@
 #include <vector>
 #include "Player.h"
 #include "Balls.h"
+#include "BallTrackSet.h"
 #include "LevelData.h"
 
 using namespace std;
@@ -12,10 +13,14 @@ class Level : public Drawable, public Updatable {
 	shared_ptr<EntityManager> entity_manager;
 
 	shared_ptr<Player> player = nullptr;
-	shared_ptr<BallTrack> ball_track = nullptr;
+	shared_ptr<BallTrackSet> ball_tracks = nullptr;
+	shared_ptr<ParticlePool> particle_pool = nullptr;
 	shared_ptr<Sprite> background_sprite = nullptr;
 	SDL_Renderer* renderer;
 
+	// revision of the level data the level was built from
+	uint data_revision = 0;
+
 public:
 	const LevelData* data;
 
@@ -26,29 +31,39 @@ public:
 		SDL_Renderer* renderer,
 		function<void(shared_ptr<EntityManager>, shared_ptr<AssetManager>, SDL_Renderer*)> create_ui
 	) : data(level_data), asset_manager(asset_manager), entity_manager(entity_manager), renderer(renderer) {
+		data_revision = data->revision;
 
+		// the background stays loaded while the level exists
 		background_sprite = entity_manager->add_entity(
 			"level_bg",
 			make_shared<Sprite>(
-				data->background,
+				asset_manager->acquire_level_background(data->id, renderer),
 				vec2(), vec2(1), 0.0F,
 				nullopt, vec2(WINDOW_WIDTH, WINDOW_HEIGHT)
 			),
 			InLevel
 		);
 
-		ball_track = entity_manager->add_entity(
-			"ball_track",
-			make_shared<BallTrack>(
-				data->track_points,
-				data->track_ball_count,
-				asset_manager,
-				entity_manager
-			),
+		ball_tracks = entity_manager->add_entity(
+			"ball_tracks",
+			make_shared<BallTrackSet>(entity_manager),
 			InLevel
 		);
 
-		ball_track->speed_multiplier = data->track_speed_multiplier;
+		for (const LevelTrack& track_data : data->tracks) {
+			auto ball_track = make_shared<BallTrack>(track_data.cache, track_data.ball_count, asset_manager);
+			ball_track->speed_multiplier = track_data.speed_multiplier;
+			ball_tracks->tracks.push_back(ball_track);
+		}
+
+		// added after the ball track for the particles to be drawn over the balls
+		particle_pool = entity_manager->add_entity(
+			"particles",
+			make_shared<ParticlePool>(&asset_manager->get_texture("ball_particle")),
+			InLevel
+		);
+		for (const shared_ptr<BallTrack>& ball_track : ball_tracks->tracks)
+			ball_track->particle_pool = particle_pool;
 
 		create_ui(entity_manager, asset_manager, renderer);
 
@@ -59,7 +74,7 @@ public:
 				asset_manager->get_texture("player_action"),
 				asset_manager,
 				entity_manager,
-				ball_track
+				ball_tracks
 			),
 			InLevel
 		);
@@ -75,13 +90,31 @@ public:
 	~Level() {
 		entity_manager->remove_entity("level_bg");
 		entity_manager->remove_entity("player");
-		entity_manager->remove_entity("ball_track");
+		entity_manager->remove_entity("ball_tracks");
+		entity_manager->remove_entity("particles");
 		entity_manager->remove_entity("game_ui");
+		asset_manager->release_level_background(data->id);
 	}
 
 	void draw(SDL_Renderer*, const RendererState&) const override {}
 
 	void update(const float& delta, GameState& game_state) override {
+		// the level data was reloaded from it's file, apply the changes without restarting the level
+		if (data_revision != data->revision) {
+			data_revision = data->revision;
+
+			// tracks can't be added or removed while their balls are in play
+			vector<shared_ptr<BallTrack>>& tracks = ball_tracks->tracks;
+			if (data->tracks.size() != tracks.size())
+				log_warn("Level: Level '%s' was reloaded with a different track count, restart it to add or remove tracks.\n", data->id.c_str());
+
+			for (uint i = 0; i < min(tracks.size(), data->tracks.size()); i++) {
+				tracks[i]->set_track(data->tracks[i].cache);
+				tracks[i]->speed_multiplier = data->tracks[i].speed_multiplier;
+			}
+			player->global_transform.position = data->player_position;
+		}
+
 		auto ui = entity_manager->get_entity_by_name<UI>("game_ui");
 		shared_ptr<Text> score_text = dynamic_pointer_cast<Text>(ui->root_element->children[1]);
 		score_text->set_content(string("Score: ") + to_string(game_state.game_score));
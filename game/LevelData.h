@@ -1,15 +1,28 @@
 #pragma once
 #include "../engine/Texture.h"
 #include "../engine/common.h"
+#include "BallTrackCache.h"
 #include <vector>
 
 using namespace std;
 
+// a ball track of a level, with it's own balls and speed
+struct LevelTrack {
+	// the track is precomputed when the level is loaded, or stored precomputed in a compiled level
+	BallTrackCache cache;
+	float speed_multiplier = 1;
+	uint ball_count = 30;
+};
+
 struct LevelData {
+	string id;
 	string name;
-	Texture* background;
-	vector<vec2> track_points;
+	// the background is loaded only while it's needed, see AssetManager::acquire_level_background
+	string background_path;
+	Texture* background = nullptr;
+	// tracks run at the same time, the level is won once all of them are cleared
+	vector<LevelTrack> tracks;
 	vec2 player_position;
-	float track_speed_multiplier = 1;
-	uint track_ball_count = 30;
+	// incremented every time the level is reloaded from it's file
+	uint revision = 0;
 };
@@ -0,0 +1,377 @@
+#include "LevelFile.h"
+#include "../engine/AssetManager.h"
+#include "TrackSpline.h"
+#include <pugixml.hpp>
+#include <cstring>
+#include <climits>
+#include <type_traits>
+
+// the points and segments are copied in as they are stored
+static_assert(is_trivially_copyable_v<vec2> && sizeof(vec2) == 2 * sizeof(float));
+static_assert(is_trivially_copyable_v<TrackSegment> && sizeof(TrackSegment) == 4 * sizeof(float));
+
+// count of the single floats before each track's arrays
+static const size_t LEVEL_FILE_TRACK_SCALAR_COUNT = 5;
+
+// reads a big endian number of the given byte count
+static uint read_big_endian(const unsigned char* bytes, size_t count) {
+	uint value = 0;
+	for (size_t i = 0; i < count; i++)
+		value = value << 8 | bytes[i];
+	return value;
+}
+
+static void write_big_endian(unsigned char* bytes, uint value, size_t count) {
+	for (size_t i = 0; i < count; i++)
+		bytes[i] = static_cast<unsigned char>(value >> (8 * (count - 1 - i)));
+}
+
+void LevelFileHeader::read(const unsigned char* bytes) {
+	version = bytes[0];
+	name_length = static_cast<ushort>(read_big_endian(bytes + 1, 2));
+	background_length = static_cast<ushort>(read_big_endian(bytes + 3, 2));
+	track_count = static_cast<ushort>(read_big_endian(bytes + 5, 2));
+}
+
+void LevelFileHeader::write(unsigned char* bytes) const {
+	bytes[0] = version;
+	write_big_endian(bytes + 1, name_length, 2);
+	write_big_endian(bytes + 3, background_length, 2);
+	write_big_endian(bytes + 5, track_count, 2);
+}
+
+void LevelTrackHeader::read(const unsigned char* bytes) {
+	ball_count = read_big_endian(bytes, 4);
+	point_count = read_big_endian(bytes + 4, 4);
+}
+
+void LevelTrackHeader::write(unsigned char* bytes) const {
+	write_big_endian(bytes, ball_count, 4);
+	write_big_endian(bytes + 4, point_count, 4);
+}
+
+// parses the ball count, speed, spline and points of a track, which are children of the node,
+// returns false and logs the error if the track has less than 2 points
+static bool parse_track(const pugi::xml_node& node, const path& level_path, LevelTrack& track) {
+	vector<vec2> points;
+	for (pugi::xml_node point : node.children("point"))
+		points.push_back(vec2(point.attribute("x").as_float(), point.attribute("y").as_float()));
+
+	if (points.size() < 2) {
+		log_error("LevelFile: Level on path '%s' has a track with less than 2 points!\n", level_path.string().c_str());
+		return false;
+	}
+
+	track.ball_count = node.child("ball-count").text().as_uint();
+	track.speed_multiplier = node.child("speed-multiplier").text().as_float();
+
+	// a spline track is tessellated here, so the game only sees evenly spaced points
+	TrackCurve curve = TCPolyline;
+	float spacing = TrackSpline::DEFAULT_SPACING;
+	pugi::xml_node spline_node = node.child("spline");
+	if (spline_node) {
+		string type = spline_node.attribute("type").as_string("centripetal");
+		if (type == "catmull-rom")
+			curve = TCCatmullRom;
+		else if (type == "centripetal")
+			curve = TCCentripetal;
+		else
+			log_warn("LevelFile: Unknown spline type '%s' in level on path '%s', using straight segments.\n", type.c_str(), level_path.string().c_str());
+		spacing = max(spline_node.attribute("spacing").as_float(TrackSpline::DEFAULT_SPACING), 1.0F);
+	}
+
+	track.cache = BallTrackCache::build(TrackSpline::tessellate(points, curve, spacing));
+	if (curve != TCPolyline)
+		track.cache.uniform_spacing = track.cache.total_length / track.cache.segments.size();
+	return true;
+}
+
+bool LevelFile::parse_xml(const char* document, size_t size, const path& level_path, LevelData& data) {
+	pugi::xml_document level_doc;
+	pugi::xml_parse_result parse_res = level_doc.load_buffer(document, size);
+
+	// the fields are read as direct children of the root, without a query for each of them
+	pugi::xml_node level = level_doc.child("level");
+	if (!parse_res || !level) {
+		log_error("LevelFile: Invalid level data document on path '%s'!\n", level_path.string().c_str());
+		return false;
+	}
+
+	// a level has either several track elements or a single track given directly in the level
+	vector<LevelTrack> tracks;
+	if (level.child("track")) {
+		for (pugi::xml_node track_node : level.children("track")) {
+			tracks.emplace_back();
+			if (!parse_track(track_node, level_path, tracks.back()))
+				return false;
+		}
+	}
+	else {
+		tracks.emplace_back();
+		if (!parse_track(level, level_path, tracks.back()))
+			return false;
+	}
+	data.tracks = move(tracks);
+
+	data.name = level.child("name").text().as_string();
+
+	// the background path is relative to the level's directory
+	path bg_path = level_path.parent_path();
+	bg_path /= level.child("background").attribute("src").as_string();
+	data.background_path = bg_path.string();
+
+	pugi::xml_node plpos_node = level.child("player-position");
+	data.player_position.x = plpos_node.attribute("x").as_float();
+	data.player_position.y = plpos_node.attribute("y").as_float();
+	return true;
+}
+
+// copies little endian floats from the cursor and advances it
+static void read_floats(const Uint8*& cursor, float* out, size_t count) {
+	memcpy(out, cursor, count * sizeof(float));
+	cursor += count * sizeof(float);
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	for (size_t i = 0; i < count; i++)
+		out[i] = SDL_SwapFloatLE(out[i]);
+#endif
+}
+
+static void write_floats(vector<Uint8>& bytes, const float* values, size_t count) {
+	size_t start = bytes.size();
+	bytes.resize(start + count * sizeof(float));
+	memcpy(bytes.data() + start, values, count * sizeof(float));
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	float* out = reinterpret_cast<float*>(bytes.data() + start);
+	for (size_t i = 0; i < count; i++)
+		out[i] = SDL_SwapFloatLE(out[i]);
+#endif
+}
+
+bool LevelFile::read(const Uint8* bytes, size_t size, const path& level_path, LevelData& data) {
+	string path_str = level_path.string();
+	const Uint8* end = bytes + size;
+
+	LevelFileHeader header;
+	if (size < LevelFileHeader::SIZE) {
+		log_error("LevelFile: Compiled level on path '%s' is truncated!\n", path_str.c_str());
+		return false;
+	}
+	header.read(bytes);
+
+	if (header.version != LevelFileHeader::VERSION) {
+		log_error("LevelFile: Compiled level on path '%s' has an unknown version %u!\n", path_str.c_str(), static_cast<uint>(header.version));
+		return false;
+	}
+
+	const Uint8* cursor = bytes + LevelFileHeader::SIZE;
+	// the tracks are of different sizes, so each part is checked before it's read
+	auto is_available = [&](Uint64 byte_count) { return static_cast<Uint64>(end - cursor) >= byte_count; };
+
+	if (header.track_count == 0 || !is_available(header.name_length + header.background_length + 2 * sizeof(float))) {
+		log_error("LevelFile: Compiled level on path '%s' is truncated or corrupted!\n", path_str.c_str());
+		return false;
+	}
+
+	data.name.assign(reinterpret_cast<const char*>(cursor), header.name_length);
+	cursor += header.name_length;
+
+	path bg_path = level_path.parent_path();
+	bg_path /= string(reinterpret_cast<const char*>(cursor), header.background_length);
+	data.background_path = bg_path.string();
+	cursor += header.background_length;
+
+	float player_position[2];
+	read_floats(cursor, player_position, 2);
+	data.player_position = vec2(player_position[0], player_position[1]);
+
+	vector<LevelTrack> tracks(header.track_count);
+	for (LevelTrack& track : tracks) {
+		if (!is_available(LevelTrackHeader::SIZE)) {
+			log_error("LevelFile: Compiled level on path '%s' is truncated!\n", path_str.c_str());
+			return false;
+		}
+
+		LevelTrackHeader track_header;
+		track_header.read(cursor);
+		cursor += LevelTrackHeader::SIZE;
+
+		Uint64 point_count = track_header.point_count;
+		Uint64 segment_count = point_count > 0 ? point_count - 1 : 0;
+		Uint64 float_count = LEVEL_FILE_TRACK_SCALAR_COUNT + point_count * 2 + segment_count * 4 + segment_count;
+		if (point_count < 2 || !is_available(float_count * sizeof(float))) {
+			log_error("LevelFile: Compiled level on path '%s' is truncated or corrupted!\n", path_str.c_str());
+			return false;
+		}
+
+		track.ball_count = track_header.ball_count;
+
+		float scalars[LEVEL_FILE_TRACK_SCALAR_COUNT];
+		read_floats(cursor, scalars, LEVEL_FILE_TRACK_SCALAR_COUNT);
+		track.speed_multiplier = scalars[0];
+
+		BallTrackCache& cache = track.cache;
+		cache.total_length = scalars[1];
+		cache.end_position = vec2(scalars[2], scalars[3]);
+		cache.uniform_spacing = scalars[4];
+
+		cache.points.resize(point_count);
+		read_floats(cursor, reinterpret_cast<float*>(cache.points.data()), point_count * 2);
+		cache.segments.resize(segment_count);
+		read_floats(cursor, reinterpret_cast<float*>(cache.segments.data()), segment_count * 4);
+		cache.arrays.start_length.resize(segment_count);
+		read_floats(cursor, cache.arrays.start_length.data(), segment_count);
+
+		// the other arrays are plain copies of the point and segment values
+		cache.fill_arrays();
+	}
+
+	if (cursor != end) {
+		log_error("LevelFile: Compiled level on path '%s' is truncated or corrupted!\n", path_str.c_str());
+		return false;
+	}
+
+	data.tracks = move(tracks);
+	return true;
+}
+
+bool LevelFile::write(const LevelData& data, const path& output_path, vector<Uint8>& bytes) {
+	// the compiled level can be written to another directory than the level XML
+	path output_directory = absolute(output_path).parent_path().lexically_normal();
+	path background = absolute(data.background_path).lexically_normal();
+	string background_str = background.lexically_relative(output_directory).generic_string();
+	if (background_str.empty())
+		background_str = background.generic_string();
+
+	// the header stores the lengths and the track count in 16 bits each
+	if (data.name.size() > USHRT_MAX || background_str.size() > USHRT_MAX || data.tracks.size() > USHRT_MAX) {
+		log_error(
+			"  %s: the name, background path or track count is longer than %u!\n",
+			output_path.string().c_str(), USHRT_MAX
+		);
+		return false;
+	}
+
+	LevelFileHeader header;
+	header.name_length = static_cast<ushort>(data.name.size());
+	header.background_length = static_cast<ushort>(background_str.size());
+	header.track_count = static_cast<ushort>(data.tracks.size());
+
+	bytes = { 'C', 'A', 'A', 'S', 'S', ATLevel };
+	bytes.resize(bytes.size() + LevelFileHeader::SIZE);
+	header.write(bytes.data() + bytes.size() - LevelFileHeader::SIZE);
+
+	bytes.insert(bytes.end(), data.name.begin(), data.name.end());
+	bytes.insert(bytes.end(), background_str.begin(), background_str.end());
+
+	float player_position[2] = { data.player_position.x, data.player_position.y };
+	write_floats(bytes, player_position, 2);
+
+	for (uint i = 0; i < header.track_count; i++) {
+		const LevelTrack& track = data.tracks[i];
+		const BallTrackCache& cache = track.cache;
+
+		LevelTrackHeader track_header;
+		track_header.ball_count = track.ball_count;
+		track_header.point_count = static_cast<uint>(cache.points.size());
+		bytes.resize(bytes.size() + LevelTrackHeader::SIZE);
+		track_header.write(bytes.data() + bytes.size() - LevelTrackHeader::SIZE);
+
+		float scalars[LEVEL_FILE_TRACK_SCALAR_COUNT] = {
+			track.speed_multiplier,
+			cache.total_length,
+			cache.end_position.x, cache.end_position.y,
+			cache.uniform_spacing
+		};
+		write_floats(bytes, scalars, LEVEL_FILE_TRACK_SCALAR_COUNT);
+		write_floats(bytes, reinterpret_cast<const float*>(cache.points.data()), cache.points.size() * 2);
+		write_floats(bytes, reinterpret_cast<const float*>(cache.segments.data()), cache.segments.size() * 4);
+		write_floats(bytes, cache.arrays.start_length.data(), cache.arrays.start_length.size());
+	}
+
+	return true;
+}
+
+// compiles a single level XML file, returns false on errors
+static bool compile_file(const path& input_path, const path& output_path) {
+	SDL_RWops* input = SDL_RWFromFile(input_path.string().c_str(), "rb");
+	if (input == nullptr) {
+		log_error("  %s: couldn't be read! Error: %s\n", input_path.string().c_str(), SDL_GetError());
+		return false;
+	}
+
+	vector<char> document(static_cast<size_t>(max(SDL_RWsize(input), static_cast<Sint64>(0))));
+	size_t read = document.empty() ? 0 : SDL_RWread(input, document.data(), document.size(), 1);
+	SDL_RWclose(input);
+	if (read != 1) {
+		log_error("  %s: couldn't be read! Error: %s\n", input_path.string().c_str(), SDL_GetError());
+		return false;
+	}
+
+	LevelData data;
+	if (!LevelFile::parse_xml(document.data(), document.size(), input_path, data))
+		return false;
+
+	vector<Uint8> bytes;
+	if (!LevelFile::write(data, output_path, bytes))
+		return false;
+
+	SDL_RWops* output = SDL_RWFromFile(output_path.string().c_str(), "wb");
+	if (output == nullptr) {
+		log_error("  %s: couldn't be written! Error: %s\n", output_path.string().c_str(), SDL_GetError());
+		return false;
+	}
+
+	bool is_written = SDL_RWwrite(output, bytes.data(), bytes.size(), 1) == 1;
+	if (SDL_RWclose(output) != 0)
+		is_written = false;
+
+	if (!is_written) {
+		log_error("  %s: couldn't be written! Error: %s\n", output_path.string().c_str(), SDL_GetError());
+		// don't leave a partial level behind
+		error_code error;
+		remove(output_path, error);
+		return false;
+	}
+
+	uint point_count = 0;
+	for (const LevelTrack& track : data.tracks)
+		point_count += static_cast<uint>(track.cache.points.size());
+
+	log_info(
+		"  %s -> %s: %u tracks, %u points, %u bytes (XML %u bytes)\n",
+		input_path.string().c_str(), output_path.string().c_str(),
+		static_cast<uint>(data.tracks.size()), point_count, static_cast<uint>(bytes.size()), static_cast<uint>(document.size())
+	);
+	return true;
+}
+
+int LevelFile::compile(const string& input_path, const string& output_path) {
+	log_info("Compiling levels from '%s'.\n", input_path.c_str());
+
+	uint failed = 0;
+	if (is_directory(input_path)) {
+		error_code error;
+		create_directories(output_path, error);
+
+		for (const auto& entry : directory_iterator(input_path)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".xml") {
+				path output_file = path(output_path) / entry.path().filename();
+				output_file.replace_extension(".calev");
+				if (!compile_file(entry.path(), output_file))
+					failed++;
+			}
+		}
+	}
+	else {
+		// the level XML isn't overwritten if no output is given
+		path output_file = output_path;
+		if (output_path == input_path)
+			output_file.replace_extension(".calev");
+		if (!compile_file(input_path, output_file))
+			failed++;
+	}
+
+	return failed == 0 ? 0 : 1;
+}
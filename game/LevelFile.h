@@ -0,0 +1,62 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "LevelData.h"
+
+using namespace std;
+using namespace filesystem;
+
+// header of a compiled level asset (ATLevel, .calev), follows the asset signature and type.
+// numbers are big endian like in other asset headers:
+//   version (1 byte), name length (2 bytes), background path length (2 bytes), track count (2 bytes)
+// the header is followed by the name and the background path relative to the level file,
+// the player position x and y as little endian floats, and then by the tracks, each made of a LevelTrackHeader
+// and little endian floats, which are copied in as they are on little endian machines:
+//   speed multiplier, total track length, track end x and y, uniform spacing,
+//   the track points (x, y), the track segments (angle, cosine, sine, length)
+//   and the track length before each segment
+struct LevelFileHeader {
+	static const size_t SIZE = 7;
+	static const Uint8 VERSION = 3;
+
+	Uint8 version = VERSION;
+	ushort name_length = 0;
+	ushort background_length = 0;
+	ushort track_count = 0;
+
+	void read(const unsigned char* bytes);
+	void write(unsigned char* bytes) const;
+};
+
+// header of a track in a compiled level, big endian:
+//   ball count (4 bytes), track point count (4 bytes)
+struct LevelTrackHeader {
+	static const size_t SIZE = 8;
+
+	uint ball_count = 0;
+	uint point_count = 0;
+
+	void read(const unsigned char* bytes);
+	void write(unsigned char* bytes) const;
+};
+
+namespace LevelFile {
+	// parses a level XML document, the background path is resolved against the level's directory,
+	// returns false and logs the error if the document isn't a valid level
+	bool parse_xml(const char* document, size_t size, const path& level_path, LevelData& data);
+
+	// reads a compiled level, starting after the asset signature and type,
+	// returns false and logs the error if it's truncated or of an unknown version
+	bool read(const Uint8* bytes, size_t size, const path& level_path, LevelData& data);
+
+	// serializes the level with it's precomputed track into a compiled level, including the asset signature,
+	// the background path is stored relative to the compiled level's directory.
+	// returns false and logs the error if the level doesn't fit the compiled format
+	bool write(const LevelData& data, const path& output_path, vector<Uint8>& bytes);
+
+	// compiles a level XML file, or every level XML file in a directory, to compiled levels,
+	// the results are logged and the return value is the process exit code
+	int compile(const string& input_path, const string& output_path);
+}
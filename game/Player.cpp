@@ -5,14 +5,14 @@ Player::Player(
 	Texture& action_texture,
 	shared_ptr<AssetManager> asset_manager,
 	shared_ptr<EntityManager> entity_manager,
-	shared_ptr<BallTrack> ball_track
+	shared_ptr<BallTrackSet> ball_tracks
 ) :
 	Sprite(&normal_texture, vec2(10, 10)),
 	normal_texture(normal_texture),
 	action_texture(action_texture),
 	asset_manager(asset_manager),
 	entity_manager(entity_manager),
-	ball_track(ball_track)
+	ball_tracks(ball_tracks)
 {
 	primary_color = get_random_ball_color();
 	secondary_color = get_random_ball_color();
@@ -38,7 +38,7 @@ void Player::shoot_ball() {
 	// create the shooting ball
 	auto shooting_ball =
 		entity_manager->add_entity_raw(
-			make_shared<PlayerBall>(asset_manager, entity_manager, ball_track, primary_color), InLevel
+			make_shared<PlayerBall>(asset_manager, entity_manager, ball_tracks, primary_color), InLevel
 		);
 
 	// copy all transforms from primary_ball to shooting_ball
@@ -53,18 +53,18 @@ void Player::shoot_ball() {
 
 	// "shift" balls forward and assign a new color to the secondary ball
 
-	auto available_colors = ball_track->get_current_colors();
+	BallColorMask available_colors = ball_tracks->get_current_colors();
 
 	// swap balls places if there is a secondary color
 	if (secondary_color)
 		swap_balls();
 	else {
-		primary_color = pick_random(available_colors);
+		primary_color = pick_random_ball_color(available_colors);
 		drawing_ball->change_color(primary_color);
 	}
 
 	// create a new color and assign it to secondary_ball
-	secondary_color = pick_random(available_colors);
+	secondary_color = pick_random_ball_color(available_colors);
 	secondary_drawing_ball->change_color(secondary_color.value());
 
 	if (drawing_ball_animation == nullptr)
@@ -240,21 +240,18 @@ void PlayerBall::update(const float& delta, GameState& game_state) {
 	// update the inherited Ball
 	Ball::update(delta, game_state);
 	// update position according to velocity
+	vec2 previous_position = global_transform.position;
 	global_transform.position += velocity * delta;
 
-	if (
-		global_transform.position.x > WINDOW_WIDTH + Ball::BALL_SIZE ||
-		global_transform.position.x < -static_cast<int>(Ball::BALL_SIZE) ||
-		global_transform.position.y > WINDOW_HEIGHT + Ball::BALL_SIZE ||
-		global_transform.position.y < -static_cast<int>(Ball::BALL_SIZE)
-	) {
-		entity_manager->schedule_to_delete(this);
-		return;
-	}
-
 	if (collision_enabled) {
-		auto collision_data = ball_track->get_collision_data(global_transform.position, 2);
+		// the whole movement since the last update is checked, so a long frame
+		// can't move the ball past the balls it should have hit
+		// the ball is inserted into the first track it hits
+		auto collision_data = ball_tracks->get_swept_collision_data(previous_position, global_transform.position, 2, ball_track);
 		if (collision_data) {
+			// move back to where the ball hit
+			global_transform.position = previous_position + velocity * delta * collision_data->time_of_impact;
+
 			uint hit_ball_index =
 				static_cast<uint>(
 					ceilf(collision_data->ball_segment_position / Ball::BALL_SIZE)
@@ -271,6 +268,16 @@ void PlayerBall::update(const float& delta, GameState& game_state) {
 		}
 	}
 
+	if (
+		global_transform.position.x > WINDOW_WIDTH + Ball::BALL_SIZE ||
+		global_transform.position.x < -static_cast<int>(Ball::BALL_SIZE) ||
+		global_transform.position.y > WINDOW_HEIGHT + Ball::BALL_SIZE ||
+		global_transform.position.y < -static_cast<int>(Ball::BALL_SIZE)
+	) {
+		entity_manager->schedule_to_delete(this);
+		return;
+	}
+
 	if (insertion_animation) {
 		if (insertion_animation->is_finished()) {
 			delete insertion_animation;
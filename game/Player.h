@@ -6,13 +6,16 @@
 #include "../engine/EntityManager.h"
 #include "GameState.h"
 #include "Balls.h"
+#include "BallTrackSet.h"
 
 // PlayerBall is used with a Player
 // it has a velocity parameter for the PlayerBall to be able to shoot
 class PlayerBall : public Ball {
 	static constexpr float BALL_SPEED = 500.0F;
 	vec2 velocity;
-	// needed to check for a collision between the BallTrack and the PlayerBall
+	// needed to check for a collision between the ball tracks and the PlayerBall
+	shared_ptr<BallTrackSet> ball_tracks = nullptr;
+	// the track the PlayerBall hit and is inserted into
 	shared_ptr<BallTrack> ball_track = nullptr;
 	// needed for PlayerBall to delete itself upon collision
 	shared_ptr<EntityManager> entity_manager = nullptr;
@@ -33,12 +36,12 @@ public:
 	PlayerBall(
 		shared_ptr<AssetManager> asset_manager,
 		shared_ptr<EntityManager> entity_manager,
-		shared_ptr<BallTrack> ball_track,
+		shared_ptr<BallTrackSet> ball_tracks,
 		BallColor color,
 		const vec2& position = vec2(),
 		const float& rotation = 0
 	)
-		: Ball(asset_manager, color, position), entity_manager(entity_manager), ball_track(ball_track)
+		: Ball(asset_manager, color, position), entity_manager(entity_manager), ball_tracks(ball_tracks)
 	{ this->global_transform.rotation = rotation; }
 
 	void update(const float& delta, GameState& game_state) override;
@@ -78,14 +81,14 @@ public:
 	shared_ptr<AssetManager> asset_manager = nullptr;
 	// needed to add PlayerBall entities and control them
 	shared_ptr<EntityManager> entity_manager = nullptr;
-	shared_ptr<BallTrack> ball_track = nullptr;
+	shared_ptr<BallTrackSet> ball_tracks = nullptr;
 
 	Player(
 		Texture& normal_texture, 
 		Texture& action_texture,
 		shared_ptr<AssetManager> asset_manager,
 		shared_ptr<EntityManager> entity_manager,
-		shared_ptr<BallTrack> ball_track
+		shared_ptr<BallTrackSet> ball_tracks
 	);
 
 	void draw(SDL_Renderer* renderer, const RendererState& renderer_state) const override;
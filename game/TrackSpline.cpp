@@ -0,0 +1,88 @@
+#include "TrackSpline.h"
+#include <cmath>
+#include <algorithm>
+
+// the spans are sampled this densely before being resampled by arc length, in samples per pixel
+static const float SAMPLES_PER_PIXEL = 1.0F;
+static const uint MIN_SPAN_SAMPLES = 8;
+
+static vec2 lerp_points(const vec2& a, const vec2& b, const float& t0, const float& t1, const float& t) {
+	// coincident knots would divide by zero, the span is a point then
+	if (t1 - t0 <= 0)
+		return a;
+	float weight = (t - t0) / (t1 - t0);
+	return vec2(a.x + (b.x - a.x) * weight, a.y + (b.y - a.y) * weight);
+}
+
+// evaluates the span between p1 and p2 with the Barry-Goldman pyramid,
+// alpha is 0 for the uniform and 0.5 for the centripetal parameterization
+static vec2 evaluate_span(const vec2& p0, const vec2& p1, const vec2& p2, const vec2& p3, const float& alpha, const float& s) {
+	float t0 = 0;
+	float t1 = t0 + powf(vec2(p0, p1).len(), alpha);
+	float t2 = t1 + powf(vec2(p1, p2).len(), alpha);
+	float t3 = t2 + powf(vec2(p2, p3).len(), alpha);
+	float t = t1 + (t2 - t1) * s;
+
+	vec2 a1 = lerp_points(p0, p1, t0, t1, t);
+	vec2 a2 = lerp_points(p1, p2, t1, t2, t);
+	vec2 a3 = lerp_points(p2, p3, t2, t3, t);
+	vec2 b1 = lerp_points(a1, a2, t0, t2, t);
+	vec2 b2 = lerp_points(a2, a3, t1, t3, t);
+	return lerp_points(b1, b2, t1, t2, t);
+}
+
+vector<vec2> TrackSpline::tessellate(const vector<vec2>& control_points, const TrackCurve& curve, const float& spacing) {
+	if (curve == TCPolyline || control_points.size() < 2 || spacing <= 0)
+		return control_points;
+
+	float alpha = curve == TCCentripetal ? 0.5F : 0.0F;
+	size_t count = control_points.size();
+
+	// the ends are extended by mirroring the neighboring point, so the first and last spans have 4 points
+	auto get_point = [&](long long index) -> vec2 {
+		if (index < 0)
+			return control_points[0] * 2 - control_points[1];
+		if (index >= static_cast<long long>(count))
+			return control_points[count - 1] * 2 - control_points[count - 2];
+		return control_points[index];
+	};
+
+	// sample the spline densely
+	vector<vec2> samples = { control_points[0] };
+	for (size_t i = 0; i + 1 < count; i++) {
+		vec2 p0 = get_point(static_cast<long long>(i) - 1);
+		vec2 p1 = control_points[i];
+		vec2 p2 = control_points[i + 1];
+		vec2 p3 = get_point(static_cast<long long>(i) + 2);
+
+		uint span_samples = max(MIN_SPAN_SAMPLES, static_cast<uint>(vec2(p1, p2).len() * SAMPLES_PER_PIXEL));
+		for (uint sample = 1; sample <= span_samples; sample++)
+			samples.push_back(evaluate_span(p0, p1, p2, p3, alpha, static_cast<float>(sample) / span_samples));
+	}
+
+	// resample the dense polyline at every spacing of arc length
+	vector<vec2> points = { samples[0] };
+	float next_length = spacing;
+	float walked_length = 0;
+	for (size_t i = 1; i < samples.size(); i++) {
+		const vec2& start = samples[i - 1];
+		const vec2& end = samples[i];
+		float length = vec2(start, end).len();
+
+		while (length > 0 && walked_length + length >= next_length) {
+			float t = (next_length - walked_length) / length;
+			points.push_back(vec2(start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t));
+			next_length += spacing;
+		}
+		walked_length += length;
+	}
+
+	// the track ends at the last control point, the last spacing is shorter than the others
+	const vec2& last = control_points[count - 1];
+	if (vec2(points.back(), last).len() > spacing * 0.01F)
+		points.push_back(last);
+	else
+		points.back() = last;
+
+	return points;
+}
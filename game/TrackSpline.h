@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include "../engine/common.h"
+
+using namespace std;
+
+// curve drawn through the authored track points
+enum TrackCurve {
+	// straight segments between the points
+	TCPolyline,
+	// Catmull-Rom spline with uniform parameterization
+	TCCatmullRom,
+	// Catmull-Rom spline with centripetal parameterization, which doesn't form loops or cusps
+	// where the points are unevenly spaced
+	TCCentripetal
+};
+
+namespace TrackSpline {
+	// distance between the tessellated points if the level doesn't give one
+	constexpr float DEFAULT_SPACING = 4.0F;
+
+	// tessellates the spline through the control points into points spaced evenly by arc length,
+	// so the track's segments form a lookup table with a fixed spacing.
+	// the spline passes through every control point, the polyline curve returns them as they are
+	vector<vec2> tessellate(const vector<vec2>& control_points, const TrackCurve& curve, const float& spacing);
+}
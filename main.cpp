@@ -1,11 +1,31 @@
 #include <SDL.h>
 #include <SDL_main.h>
 #include "engine/Engine.h"
+#include "engine/LaunchOptions.h"
+#include "engine/Benchmarks.h"
+#include "engine/FrameCapture.h"
+#include "engine/AssetPack.h"
+#include "game/LevelFile.h"
 #include <pugixml.hpp>
 
-int main(int, char**) {
+int main(int argc, char** argv) {
 	SDL_LogSetAllPriority(SDL_LOG_PRIORITY_VERBOSE);
-	Engine* engine = new Engine();
+	LaunchOptions options = LaunchOptions::parse(argc, argv);
+
+	if (!options.build_pack_path.empty())
+		return AssetPack::build("assets", options.build_pack_path);
+	if (!options.convert_input.empty())
+		return RawTexture::convert(options.convert_input, options.convert_output, options.convert_format, options.convert_premultiply, options.convert_compress);
+	if (!options.compile_input.empty())
+		return LevelFile::compile(options.compile_input, options.compile_output);
+	if (!options.compare_expected.empty())
+		return run_frame_compare(options.compare_expected, options.compare_actual, options.compare_tolerance);
+	if (options.bench_kernels)
+		return run_kernel_benchmark();
+	if (options.bench_render)
+		return run_render_benchmark();
+
+	Engine* engine = new Engine(options);
 	engine->run_loop();
 	delete engine;
 	IMG_Quit();